@@ -0,0 +1,39 @@
+#include <step/step_loader.hpp>
+
+#include "step_generator.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <string_view>
+
+using namespace std;
+
+namespace {
+
+// Arguments: entity count, load threads, StepSchema.
+void BM_StepLoader(benchmark::State& state)
+{
+    auto schema = StepSchema(state.range(2));
+    auto& text
+        = synthetic_step(size_t(state.range(0)), StepMix::MIXED, schema);
+    stp::Options options;
+    options.load_threads = size_t(state.range(1));
+    size_t records = 0;
+
+    for (auto _ : state) {
+        StepLoader load(string_view(text), options);
+        records = load.data().size();
+        benchmark::DoNotOptimize(records);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations() * text.size()));
+    state.counters["records"] = double(records);
+    state.SetLabel(to_string(schema));
+}
+
+} // namespace
+
+BENCHMARK(BM_StepLoader)
+    ->ArgNames({"entities", "threads", "schema"})
+    ->ArgsProduct({benchmark::CreateRange(1000, 10000000, 10), {1, 0},
+                   {int64_t(StepSchema::AP214), int64_t(StepSchema::AP203)}})
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,122 @@
+#include <step/step_entities.hpp>
+#include <step/step_loader.hpp>
+#include <step/step_parser.hpp>
+
+#include "alloc_counter.hpp"
+#include "step_generator.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+using filter_t = function<bool(StepEntity)>;
+using getter_t = function<void(StepParser&, size_t)>;
+
+// Complex instances in synthetic files are units, not rational splines.
+bool is_curve(StepEntity type)
+{
+    return type != StepEntity::COMPLEX && find_curve(type).has_value();
+}
+
+bool is_surface(StepEntity type)
+{
+    return type != StepEntity::COMPLEX && find_surface(type).has_value();
+}
+
+string label(StepMix mix, StepSchema schema)
+{
+    return string(to_string(mix)) + "/" + to_string(schema);
+}
+
+// Builds every entity filter accepts with a fresh parser per iteration, so
+// that each one is read from tokens rather than taken from a cache. Only
+// allocations made while building are counted, not those of the parser.
+void run(benchmark::State& state, const filter_t& filter,
+         const getter_t& get)
+{
+    auto mix = StepMix(state.range(1));
+    auto schema = StepSchema(state.range(2));
+    StepLoader load(
+        string_view(synthetic_step(size_t(state.range(0)), mix, schema)));
+    vector<size_t> ids;
+    load.data().for_each([&](size_t id, const StepRecord& record) {
+        if (filter(record.type))
+            ids.push_back(id);
+    });
+
+    size_t allocs = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        StepParser parse(load);
+        state.ResumeTiming();
+        auto before = allocation_count();
+        for (auto i : ids)
+            get(parse, i);
+        allocs += allocation_count() - before;
+    }
+    auto entities = state.iterations() * ids.size();
+    state.SetItemsProcessed(int64_t(entities));
+    state.counters["allocs/entity"]
+        = entities ? double(allocs) / double(entities) : 0.;
+    state.SetLabel(label(mix, schema));
+}
+
+void BM_GetCurve(benchmark::State& state)
+{
+    run(state, is_curve, [](StepParser& parse, size_t id) {
+        benchmark::DoNotOptimize(parse.get_curve(id));
+    });
+}
+
+void BM_GetSurface(benchmark::State& state)
+{
+    run(state, is_surface, [](StepParser& parse, size_t id) {
+        benchmark::DoNotOptimize(parse.get_surface(id));
+    });
+}
+
+void BM_GetFace(benchmark::State& state)
+{
+    run(
+        state,
+        [](StepEntity type) { return type == StepEntity::ADVANCED_FACE; },
+        [](StepParser& parse, size_t id) {
+            benchmark::DoNotOptimize(parse.get_face(id));
+        });
+}
+
+void BM_Parse(benchmark::State& state)
+{
+    auto mix = StepMix(state.range(1));
+    auto schema = StepSchema(state.range(2));
+    StepLoader load(
+        string_view(synthetic_step(size_t(state.range(0)), mix, schema)));
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(StepParser(load).parse().take_geom());
+    state.SetLabel(label(mix, schema));
+}
+
+void mixes(benchmark::internal::Benchmark* bench)
+{
+    bench->ArgNames({"entities", "mix", "schema"})
+        ->ArgsProduct({benchmark::CreateRange(1000, 1000000, 10),
+                       benchmark::CreateDenseRange(0, 3, 1),
+                       {int64_t(StepSchema::AP214),
+                        int64_t(StepSchema::AP203)}})
+        ->Unit(benchmark::kMillisecond);
+}
+
+} // namespace
+
+BENCHMARK(BM_GetCurve)->Apply(mixes);
+BENCHMARK(BM_GetSurface)->Apply(mixes);
+BENCHMARK(BM_GetFace)->Apply(mixes);
+BENCHMARK(BM_Parse)->Apply(mixes);
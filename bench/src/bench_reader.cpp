@@ -0,0 +1,60 @@
+#include <step/step_reader.hpp>
+#include <step/step_tokenizer.hpp>
+#include <tokenizer/token_cursor.hpp>
+
+#include "alloc_counter.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+template <class... Args>
+void BM_StepRead(benchmark::State& state, string_view text)
+{
+    auto tokens = step_lex(text);
+    auto before = allocation_count();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(step_read<Args...>(TokenCursor(tokens)));
+    state.SetItemsProcessed(int64_t(state.iterations()));
+    state.counters["allocs"] = benchmark::Counter(
+        double(allocation_count() - before),
+        benchmark::Counter::kAvgIterations);
+}
+
+// BENCHMARK_CAPTURE cannot name template instances
+template <class... Args>
+void add(const char* name, string_view text)
+{
+    benchmark::RegisterBenchmark(
+        name, [text](benchmark::State& state) {
+            BM_StepRead<Args...>(state, text);
+        });
+}
+
+const auto registered = [] {
+    add<str_>("BM_StepRead/str_", "'label'");
+    add<ref_>("BM_StepRead/ref_", "#12345");
+    add<int_>("BM_StepRead/int_", "3");
+    add<bool_>("BM_StepRead/bool_", ".T.");
+    add<float_>("BM_StepRead/float_", "0.125");
+    add<vec_>("BM_StepRead/vec_", "(0.5,-1.25,2.)");
+    add<list_<float_>>("BM_StepRead/list_<float_>",
+                       "(0.,1.,2.,3.,4.,5.,6.,7.)");
+    add<list_<int_>>("BM_StepRead/list_<int_>", "(4,1,1,1,1,4)");
+    add<rlist_>("BM_StepRead/rlist_", "(#1,#2,#3,#4,#5,#6,#7,#8)");
+    add<mat_<ref_>>("BM_StepRead/mat_<ref_>",
+                    "((#1,#2,#3,#4),(#5,#6,#7,#8),(#9,#10,#11,#12),"
+                    "(#13,#14,#15,#16))");
+    add<mat_<float_>>("BM_StepRead/mat_<float_>",
+                      "((1.,0.5,1.),(0.5,1.,0.5),(1.,0.5,1.))");
+    add<br_<i_<str_>, ref_, float_>>("BM_StepRead/br_", "('',#42,2.5)");
+    add<i_<str_, bool_>>("BM_StepRead/i_", "'ignored' .F.");
+    return true;
+}();
+
+} // namespace
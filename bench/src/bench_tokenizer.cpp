@@ -0,0 +1,65 @@
+#include <step/step_loader.hpp>
+#include <step/step_tokenizer.hpp>
+
+#include "step_generator.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+vector<string_view> records(StepMix mix)
+{
+    StepLoader load(string_view(synthetic_step(100000, mix)));
+    vector<string_view> result;
+    load.data().for_each([&](size_t, const StepRecord& record) {
+        result.push_back(record.text);
+    });
+    return result;
+}
+
+void BM_Tokenizer(benchmark::State& state)
+{
+    auto mix = StepMix(state.range(0));
+    auto text = records(mix);
+    size_t bytes = 0, tokens = 0;
+
+    for (auto _ : state) {
+        for (auto i : text) {
+            StepTokenizer tok(i);
+            for (; !tok.eof(); ++tok) {
+                benchmark::DoNotOptimize(*tok);
+                ++tokens;
+            }
+            bytes += i.size();
+        }
+    }
+    state.SetBytesProcessed(int64_t(bytes));
+    state.SetItemsProcessed(int64_t(tokens));
+    state.SetLabel(to_string(mix));
+}
+
+void BM_StepLex(benchmark::State& state)
+{
+    auto mix = StepMix(state.range(0));
+    auto text = records(mix);
+    size_t bytes = 0;
+
+    for (auto _ : state) {
+        for (auto i : text) {
+            benchmark::DoNotOptimize(step_lex(i));
+            bytes += i.size();
+        }
+    }
+    state.SetBytesProcessed(int64_t(bytes));
+    state.SetLabel(to_string(mix));
+}
+
+} // namespace
+
+BENCHMARK(BM_Tokenizer)->DenseRange(0, 3)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_StepLex)->DenseRange(0, 3)->Unit(benchmark::kMillisecond);
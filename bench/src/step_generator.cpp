@@ -0,0 +1,369 @@
+#include "step_generator.hpp"
+
+#include <fmt/format.h>
+
+#include <array>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+using vec_t = array<double, 3>;
+
+class Generator {
+public:
+    explicit Generator(const StepGeneratorOptions& options)
+        : options_(options)
+        , rng_(options.seed)
+        , out_()
+        , next_(1)
+    {
+    }
+
+    string run()
+    {
+        auto ap203 = options_.schema == StepSchema::AP203;
+        out_ += "ISO-10303-21;\nHEADER;\n"
+                "FILE_DESCRIPTION(('synthetic B-rep model'),'2;1');\n"
+                "FILE_NAME('synthetic.stp','2000-01-01T00:00:00',(''),(''),"
+                "'stp_bench','stp_bench','');\n";
+        out_ += ap203 ? "FILE_SCHEMA(('CONFIG_CONTROL_DESIGN'));\n"
+                      : "FILE_SCHEMA(('AUTOMOTIVE_DESIGN "
+                        "{ 1 0 10303 214 1 1 1 1 }'));\n";
+        out_ += "ENDSEC;\nDATA;\n";
+
+        auto shape = product(ap203);
+        auto context = units();
+        vector<size_t> items;
+        for (size_t i = 0; next_ < options_.entities; ++i) {
+            vec_t origin {3. * double(i % 1000), 3. * double(i / 1000), 0.};
+            switch (pick()) {
+            case StepMix::CYLINDERS:
+                items.push_back(solid(cylinder(origin)));
+                break;
+            case StepMix::BSPLINES:
+                items.push_back(solid(box(origin, true)));
+                break;
+            default:
+                items.push_back(solid(box(origin, false)));
+            }
+        }
+        items.push_back(axis({0., 0., 0.}, {0., 0., 1.}, {1., 0., 0.}));
+        auto rep = emit(fmt::format(
+            "ADVANCED_BREP_SHAPE_REPRESENTATION('',{},#{})", refs(items),
+            context));
+        emit(fmt::format("SHAPE_DEFINITION_REPRESENTATION(#{},#{})", shape,
+                         rep));
+
+        out_ += "ENDSEC;\nEND-ISO-10303-21;\n";
+        return move(out_);
+    }
+
+private:
+    // Draws from the raw engine output, whose sequence the standard fixes,
+    // unlike that of the distributions.
+    StepMix pick()
+    {
+        if (options_.mix != StepMix::MIXED)
+            return options_.mix;
+        return array<StepMix, 3> {StepMix::PLANES, StepMix::CYLINDERS,
+                                  StepMix::BSPLINES}[rng_() % 3];
+    }
+
+    size_t emit(string_view entity)
+    {
+        out_ += fmt::format("#{}={};\n", next_, entity);
+        return next_++;
+    }
+
+    static string real(double x)
+    {
+        return fmt::format("{:.6f}", x);
+    }
+
+    static string refs(const vector<size_t>& ids)
+    {
+        string result = "(";
+        for (size_t i = 0; i < ids.size(); ++i)
+            result += fmt::format(i ? ",#{}" : "#{}", ids[i]);
+        return result + ")";
+    }
+
+    size_t product(bool ap203)
+    {
+        auto app = emit(
+            ap203 ? "APPLICATION_CONTEXT('configuration controlled 3d "
+                    "designs of mechanical parts and assemblies')"
+                  : "APPLICATION_CONTEXT('automotive design')");
+        emit(fmt::format("APPLICATION_PROTOCOL_DEFINITION('international "
+                         "standard','{}',{},#{})",
+                         ap203 ? "config_control_design"
+                               : "automotive_design",
+                         ap203 ? 1994 : 2000, app));
+        auto context = emit(fmt::format(
+            "{}('',#{},'mechanical')",
+            ap203 ? "MECHANICAL_CONTEXT" : "PRODUCT_CONTEXT", app));
+        auto product = emit(fmt::format(
+            "PRODUCT('synthetic','synthetic','',(#{}))", context));
+        auto formation = emit(
+            ap203 ? fmt::format("PRODUCT_DEFINITION_FORMATION_WITH_"
+                                "SPECIFIED_SOURCE('','',#{},.NOT_KNOWN.)",
+                                product)
+                  : fmt::format("PRODUCT_DEFINITION_FORMATION('','',#{})",
+                                product));
+        auto def_context = emit(fmt::format(
+            "PRODUCT_DEFINITION_CONTEXT('{}',#{},'design')",
+            ap203 ? "detailed design" : "part definition", app));
+        auto def = emit(fmt::format("PRODUCT_DEFINITION('design','',#{},#{})",
+                                    formation, def_context));
+        return emit(fmt::format("PRODUCT_DEFINITION_SHAPE('','',#{})", def));
+    }
+
+    size_t units()
+    {
+        auto length = emit(
+            "(LENGTH_UNIT() NAMED_UNIT(*) SI_UNIT(.MILLI.,.METRE.))");
+        auto angle = emit(
+            "(NAMED_UNIT(*) PLANE_ANGLE_UNIT() SI_UNIT($,.RADIAN.))");
+        auto solid_angle = emit(
+            "(NAMED_UNIT(*) SI_UNIT($,.STERADIAN.) SOLID_ANGLE_UNIT())");
+        auto uncertainty = emit(fmt::format(
+            "UNCERTAINTY_MEASURE_WITH_UNIT(LENGTH_MEASURE(1.E-07),#{},"
+            "'distance_accuracy_value','confusion accuracy')",
+            length));
+        return emit(fmt::format(
+            "(GEOMETRIC_REPRESENTATION_CONTEXT(3) "
+            "GLOBAL_UNCERTAINTY_ASSIGNED_CONTEXT((#{})) "
+            "GLOBAL_UNIT_ASSIGNED_CONTEXT((#{},#{},#{})) "
+            "REPRESENTATION_CONTEXT('','3D'))",
+            uncertainty, length, angle, solid_angle));
+    }
+
+    size_t point(const vec_t& p)
+    {
+        return emit(fmt::format("CARTESIAN_POINT('',({},{},{}))", real(p[0]),
+                                real(p[1]), real(p[2])));
+    }
+
+    size_t direction(const vec_t& d)
+    {
+        return emit(fmt::format("DIRECTION('',({},{},{}))", real(d[0]),
+                                real(d[1]), real(d[2])));
+    }
+
+    size_t axis(const vec_t& origin, const vec_t& z, const vec_t& x)
+    {
+        auto p = point(origin);
+        auto dz = direction(z), dx = direction(x);
+        return emit(
+            fmt::format("AXIS2_PLACEMENT_3D('',#{},#{},#{})", p, dz, dx));
+    }
+
+    size_t line(size_t p, const vec_t& d, double length)
+    {
+        auto dir = direction(d);
+        auto vec = emit(fmt::format("VECTOR('',#{},{})", dir, real(length)));
+        return emit(fmt::format("LINE('',#{},#{})", p, vec));
+    }
+
+    size_t edge(size_t first, size_t last, size_t curve)
+    {
+        return emit(fmt::format("EDGE_CURVE('',#{},#{},#{},.T.)", first, last,
+                                curve));
+    }
+
+    size_t oedge(size_t edge, bool orientation)
+    {
+        return emit(fmt::format("ORIENTED_EDGE('',*,*,#{},{})", edge,
+                                orientation ? ".T." : ".F."));
+    }
+
+    size_t face(const vector<size_t>& oedges, size_t surface)
+    {
+        auto loop = emit(fmt::format("EDGE_LOOP('',{})", refs(oedges)));
+        auto bound = emit(fmt::format("FACE_OUTER_BOUND('',#{},.T.)", loop));
+        return emit(
+            fmt::format("ADVANCED_FACE('',(#{}),#{},.T.)", bound, surface));
+    }
+
+    size_t solid(const vector<size_t>& faces)
+    {
+        auto shell = emit(fmt::format("CLOSED_SHELL('',{})", refs(faces)));
+        return emit(fmt::format("MANIFOLD_SOLID_BREP('',#{})", shell));
+    }
+
+    // Flat degree 3 patch spanning the unit square at height 1 above
+    // origin, so that it matches the straight edges of the box top.
+    size_t bspline(const vec_t& origin)
+    {
+        auto n = max<size_t>(options_.grid, 4);
+        string rows;
+        for (size_t i = 0; i < n; ++i) {
+            vector<size_t> row;
+            for (size_t j = 0; j < n; ++j)
+                row.push_back(point({origin[0] + double(i) / double(n - 1),
+                                     origin[1] + double(j) / double(n - 1),
+                                     origin[2] + 1.}));
+            rows += (i ? "," : "") + refs(row);
+        }
+        string mult = "(4", knots = "(0.";
+        for (size_t i = 1; i + 3 < n; ++i) {
+            mult += ",1";
+            knots += "," + real(double(i));
+        }
+        mult += ",4)";
+        knots += "," + real(double(n - 3)) + ")";
+        return emit(fmt::format(
+            "B_SPLINE_SURFACE_WITH_KNOTS('',3,3,({}),.UNSPECIFIED.,.F.,.F.,"
+            ".F.,{},{},{},{},.UNSPECIFIED.)",
+            rows, mult, mult, knots, knots));
+    }
+
+    // Unit cube at origin. Corner i sits at the offsets given by bits 2, 1
+    // and 0 of i along x, y and z; loops run counterclockwise seen from
+    // outside.
+    vector<size_t> box(const vec_t& origin, bool bspline_top)
+    {
+        static constexpr array<array<size_t, 4>, 6> quads {{{0, 2, 6, 4},
+                                                            {1, 5, 7, 3},
+                                                            {0, 4, 5, 1},
+                                                            {2, 3, 7, 6},
+                                                            {0, 1, 3, 2},
+                                                            {4, 6, 7, 5}}};
+        static constexpr array<vec_t, 6> normals {{{0., 0., -1.},
+                                                   {0., 0., 1.},
+                                                   {0., -1., 0.},
+                                                   {0., 1., 0.},
+                                                   {-1., 0., 0.},
+                                                   {1., 0., 0.}}};
+
+        array<vec_t, 8> corners;
+        array<size_t, 8> points, vertices;
+        for (size_t i = 0; i < 8; ++i) {
+            corners[i] = {origin[0] + double(i >> 2 & 1),
+                          origin[1] + double(i >> 1 & 1),
+                          origin[2] + double(i & 1)};
+            points[i] = point(corners[i]);
+            vertices[i] = emit(fmt::format("VERTEX_POINT('',#{})", points[i]));
+        }
+        auto along = [&](size_t i, size_t j) {
+            return vec_t {corners[j][0] - corners[i][0],
+                          corners[j][1] - corners[i][1],
+                          corners[j][2] - corners[i][2]};
+        };
+
+        map<pair<size_t, size_t>, size_t> edges;
+        vector<size_t> result;
+        for (size_t k = 0; k < quads.size(); ++k) {
+            auto& q = quads[k];
+            vector<size_t> oedges;
+            for (size_t t = 0; t < 4; ++t) {
+                auto i = q[t], j = q[(t + 1) % 4];
+                if (auto it = edges.find({j, i}); it != edges.end()) {
+                    oedges.push_back(oedge(it->second, false));
+                } else {
+                    auto c = line(points[i], along(i, j), 1.);
+                    auto e = edges[{i, j}] = edge(vertices[i], vertices[j], c);
+                    oedges.push_back(oedge(e, true));
+                }
+            }
+            auto surface = bspline_top && k == 1
+                ? bspline(origin)
+                : emit(fmt::format("PLANE('',#{})",
+                                   axis(corners[q[0]], normals[k],
+                                        along(q[0], q[1]))));
+            result.push_back(face(oedges, surface));
+        }
+        return result;
+    }
+
+    // Cylinder of radius 0.5 and height 1 standing on origin, its lateral
+    // face closed by a seam line.
+    vector<size_t> cylinder(const vec_t& origin)
+    {
+        const double r = 0.5;
+        vec_t top {origin[0], origin[1], origin[2] + 1.};
+        vec_t z {0., 0., 1.}, x {1., 0., 0.};
+
+        auto pb = point({origin[0] + r, origin[1], origin[2]});
+        auto pt = point({top[0] + r, top[1], top[2]});
+        auto vb = emit(fmt::format("VERTEX_POINT('',#{})", pb));
+        auto vt = emit(fmt::format("VERTEX_POINT('',#{})", pt));
+
+        auto ab = axis(origin, z, x), at = axis(top, z, x);
+        auto cb = edge(vb, vb,
+                       emit(fmt::format("CIRCLE('',#{},{})", ab, real(r))));
+        auto ct = edge(vt, vt,
+                       emit(fmt::format("CIRCLE('',#{},{})", at, real(r))));
+        auto seam = edge(vb, vt, line(pb, z, 1.));
+
+        auto bottom = emit(fmt::format(
+            "PLANE('',#{})", axis(origin, {0., 0., -1.}, x)));
+        auto lid = emit(fmt::format("PLANE('',#{})", at));
+        auto side = emit(
+            fmt::format("CYLINDRICAL_SURFACE('',#{},{})", ab, real(r)));
+
+        return {face({oedge(cb, false)}, bottom),
+                face({oedge(ct, true)}, lid),
+                face({oedge(cb, true), oedge(seam, true), oedge(ct, false),
+                      oedge(seam, false)},
+                     side)};
+    }
+
+    StepGeneratorOptions options_;
+    mt19937 rng_;
+    string out_;
+    size_t next_;
+};
+
+} // namespace
+
+string generate_step(const StepGeneratorOptions& options)
+{
+    return Generator(options).run();
+}
+
+const string& synthetic_step(size_t entities, StepMix mix, StepSchema schema)
+{
+    static mutex lock;
+    static map<tuple<size_t, StepMix, StepSchema>, unique_ptr<string>> cache;
+
+    lock_guard<mutex> guard(lock);
+    auto& result = cache[{entities, mix, schema}];
+    if (!result) {
+        StepGeneratorOptions options;
+        options.entities = entities;
+        options.mix = mix;
+        options.schema = schema;
+        result = make_unique<string>(generate_step(options));
+    }
+    return *result;
+}
+
+const char* to_string(StepMix mix)
+{
+    switch (mix) {
+    case StepMix::PLANES:
+        return "planes";
+    case StepMix::CYLINDERS:
+        return "cylinders";
+    case StepMix::BSPLINES:
+        return "bsplines";
+    case StepMix::MIXED:
+        break;
+    }
+    return "mixed";
+}
+
+const char* to_string(StepSchema schema)
+{
+    return schema == StepSchema::AP203 ? "ap203" : "ap214";
+}
@@ -0,0 +1,38 @@
+#ifndef STEPPARSE_BENCH_SRC_STEP_GENERATOR_HPP_
+#define STEPPARSE_BENCH_SRC_STEP_GENERATOR_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Kinds of solids a synthetic model is made of: boxes bounded by planes,
+// cylinders, boxes with a dense B-spline top face, or an even mix of all.
+enum class StepMix { PLANES, CYLINDERS, BSPLINES, MIXED };
+
+enum class StepSchema { AP203, AP214 };
+
+struct StepGeneratorOptions {
+    // Approximate number of entity instances in the DATA section.
+    size_t entities = 1000;
+    StepMix mix = StepMix::MIXED;
+    StepSchema schema = StepSchema::AP214;
+    // Control points per side of B-spline surfaces.
+    size_t grid = 16;
+    uint32_t seed = 1;
+};
+
+// Emits a STEP physical file with a product, its units and one advanced
+// B-rep of closed solids. The text only depends on options, so inputs of
+// a benchmark are the same on every machine.
+std::string generate_step(const StepGeneratorOptions& options);
+
+// generate_step() with the given size, mix and schema, generated once per
+// process.
+const std::string& synthetic_step(size_t entities,
+                                  StepMix mix = StepMix::MIXED,
+                                  StepSchema schema = StepSchema::AP214);
+
+const char* to_string(StepMix mix);
+const char* to_string(StepSchema schema);
+
+#endif // STEPPARSE_BENCH_SRC_STEP_GENERATOR_HPP_
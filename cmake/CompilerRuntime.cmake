@@ -0,0 +1,21 @@
+include_guard(GLOBAL)
+
+# Dependencies such as GTest or google benchmark may come from a prefix
+# shipping an older C++ runtime than the compiler's, which executables
+# linked against them would otherwise pick up at run time and fail to
+# start. Adds the directory of the compiler's own runtime to the build
+# rpath of target; installed targets are not affected.
+function(stp_use_compiler_runtime target)
+  execute_process(
+    COMMAND ${CMAKE_CXX_COMPILER} -print-file-name=libstdc++.so.6
+    OUTPUT_VARIABLE runtime
+    OUTPUT_STRIP_TRAILING_WHITESPACE
+    ERROR_QUIET
+  )
+  if (IS_ABSOLUTE "${runtime}")
+    get_filename_component(runtime_dir "${runtime}" DIRECTORY)
+    set_property(TARGET ${target}
+      APPEND PROPERTY BUILD_RPATH "${runtime_dir}"
+    )
+  endif()
+endfunction()
@@ -0,0 +1,54 @@
+#ifndef STEPPARSE_INCLUDE_STP_ASYNC_HPP_
+#define STEPPARSE_INCLUDE_STP_ASYNC_HPP_
+
+#include "exports.hpp"
+#include "options.hpp"
+#include "progress.hpp"
+
+#include <gm/shell.hpp>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace stp {
+
+// Handle of a parse running on its own thread.
+class STP_EXPORT ParseTask {
+public:
+    ParseTask(ParseTask&&) noexcept;
+    ParseTask& operator=(ParseTask&&) noexcept;
+    // Cancels the parse unless its result was taken and waits for it.
+    ~ParseTask();
+
+    const ParseProgress& progress() const;
+    // Asks the parse to stop; it does before the next face it would start.
+    void cancel() noexcept;
+
+    bool ready() const;
+    void wait() const;
+    bool wait_for(std::chrono::milliseconds timeout) const;
+    // Waits for the parse and returns its shells, or throws what stopped
+    // it, including when it was cancelled. May be called once.
+    std::vector<gm::Shell> get();
+
+private:
+    friend ParseTask parse_async(const std::string&, const Options&);
+
+    struct State;
+
+    explicit ParseTask(std::unique_ptr<State> state);
+
+    std::unique_ptr<State> state_;
+};
+
+// Starts parsing a file on a new thread. options.progress is replaced by
+// the progress of the task; stats and trace are used as by parse() and
+// must outlive the task.
+STP_EXPORT ParseTask parse_async(const std::string& str,
+                                 const Options& options = Options());
+
+} // namespace stp
+
+#endif // STEPPARSE_INCLUDE_STP_ASYNC_HPP_
@@ -0,0 +1,83 @@
+#ifndef STEPPARSE_INCLUDE_STP_BATCH_HPP_
+#define STEPPARSE_INCLUDE_STP_BATCH_HPP_
+
+#include "exports.hpp"
+#include "options.hpp"
+
+#include <gm/shell.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace stp {
+
+// Outcome of parsing one file of a batch: its shells, or the exception
+// that stopped the parse, in which case shells is empty. If the batch is
+// lenient, i.e. Options::diagnostics is set, the faces and shells skipped
+// in the file are reported in diagnostics rather than in the options.
+struct BatchResult {
+    std::string path;
+    std::vector<gm::Shell> shells;
+    Diagnostics diagnostics;
+    std::exception_ptr error;
+    size_t bytes = 0;
+    std::chrono::nanoseconds time {};
+};
+
+struct STP_EXPORT BatchStats {
+    size_t files = 0;
+    size_t failed = 0;
+    size_t bytes = 0;
+    // Wall time of the whole batch.
+    std::chrono::nanoseconds time {};
+
+    double files_per_second() const;
+    double bytes_per_second() const;
+};
+
+using batch_callback_t = std::function<void(BatchResult&&)>;
+
+// Parses many files on one work-stealing pool that is kept between calls.
+// Larger files are started first; a file larger than its even share of a
+// batch is also split into loader chunks and faces run on the same pool,
+// so one huge file does not finish long after the others.
+class STP_EXPORT BatchParser {
+public:
+    BatchParser(const BatchParser&) = delete;
+    BatchParser& operator=(const BatchParser&) = delete;
+
+    // 0 threads means one per hardware thread
+    explicit BatchParser(size_t threads = 0);
+    ~BatchParser();
+
+    size_t threads() const;
+
+    // Hands the result of every file to callback on the calling thread, in
+    // the order the files finish. options.load_threads and parse_threads
+    // are ignored, the pool is used instead. If callback throws, files not
+    // yet started are skipped and the exception is rethrown once running
+    // ones finish.
+    BatchStats parse(const std::vector<std::string>& paths,
+                     const batch_callback_t& callback,
+                     const Options& options = Options());
+
+private:
+    struct Impl;
+
+    std::unique_ptr<Impl> impl_;
+};
+
+// Parses paths on a pool of one thread per hardware thread created for the
+// call; keep a BatchParser to reuse its pool over several batches.
+STP_EXPORT BatchStats parse_batch(const std::vector<std::string>& paths,
+                                  const batch_callback_t& callback,
+                                  const Options& options = Options());
+
+} // namespace stp
+
+#endif // STEPPARSE_INCLUDE_STP_BATCH_HPP_
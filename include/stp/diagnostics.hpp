@@ -0,0 +1,29 @@
+#ifndef STEPPARSE_INCLUDE_STP_DIAGNOSTICS_HPP_
+#define STEPPARSE_INCLUDE_STP_DIAGNOSTICS_HPP_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace stp {
+
+// A face or shell a lenient parse skipped because it could not be built,
+// see Options::diagnostics.
+struct Diagnostic {
+    static constexpr auto npos = std::string::npos;
+
+    // STEP #id and keyword of the skipped record. The record that actually
+    // failed may be one it refers to, reason tells which.
+    size_t id = 0;
+    std::string entity;
+    // Byte offset of the keyword of the skipped record in the input, npos
+    // if the record is missing.
+    size_t offset = npos;
+    std::string reason;
+};
+
+using Diagnostics = std::vector<Diagnostic>;
+
+} // namespace stp
+
+#endif // STEPPARSE_INCLUDE_STP_DIAGNOSTICS_HPP_
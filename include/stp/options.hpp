@@ -0,0 +1,67 @@
+#ifndef STEPPARSE_INCLUDE_STP_OPTIONS_HPP_
+#define STEPPARSE_INCLUDE_STP_OPTIONS_HPP_
+
+#include "diagnostics.hpp"
+#include "exports.hpp"
+#include "progress.hpp"
+#include "stats.hpp"
+#include "trace.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <memory_resource>
+
+namespace stp {
+
+struct STP_EXPORT Options {
+    // Threads indexing the DATA section, 0 means one per hardware thread.
+    // Small inputs are always indexed on the calling thread.
+    size_t load_threads = 1;
+    // Threads building faces, 0 means one per hardware thread. The result
+    // is the same as with a single thread.
+    size_t parse_threads = 1;
+    // Keep the record index of parsed files in a <file>.stpidx sidecar and
+    // reuse it while the file content is unchanged. Only applies to files
+    // parsed by path; a stale or damaged sidecar is rebuilt. A load served
+    // from the sidecar scans nothing, so it adds no bytes_scanned or
+    // records_seen to stats.
+    bool index_cache = false;
+    // Drop the pages of a file from memory once it is indexed, so that only
+    // records the shells reach are read back when first parsed and resident
+    // memory follows the reachable geometry rather than the file size.
+    // Only applies to files parsed by path.
+    bool lazy_records = false;
+    // Most decoded entities and lexed records the parser keeps for reuse,
+    // 0 for no limit. This is a count of entries, not of bytes: a B-spline
+    // surface counts as one entry, as do its lexed record and a point.
+    // Entries past the limit are not kept, so they may be decoded and
+    // lexed again. With a limit, parse() allocates from the heap rather
+    // than an arena so that entries not kept are freed.
+    size_t cache_entry_limit = 0;
+    // Memory lexed records, the record lists of loader chunks and other
+    // data kept only for the duration of a parse are allocated from, which
+    // must be safe to use from several threads if load_threads or
+    // parse_threads is not 1. If null, parse() allocates them from an arena
+    // freed in one go when it returns unless cache_entry_limit is set,
+    // parse_each() from the heap so that records no later shell needs are
+    // freed as it goes, and the loader from the heap.
+    std::pmr::memory_resource* memory_resource = nullptr;
+    // Makes the parse lenient if not null: a face or shell that cannot be
+    // built is skipped and reported here, in file order, instead of failing
+    // the whole parse. Files that cannot be loaded and cancelled parses
+    // still throw.
+    Diagnostics* diagnostics = nullptr;
+    // Progress of the parse is reported here if not null, which also allows
+    // cancelling it.
+    ParseProgress* progress = nullptr;
+    // Statistics of the parse are added here if not null.
+    ParseStats* stats = nullptr;
+    // Receives trace events of loader chunks, shells and faces if not null,
+    // and of curves and surfaces taking at least trace_threshold to build.
+    TraceSink* trace = nullptr;
+    std::chrono::microseconds trace_threshold {10000};
+};
+
+} // namespace stp
+
+#endif // STEPPARSE_INCLUDE_STP_OPTIONS_HPP_
@@ -2,16 +2,66 @@
 #define STEPPARSE_INCLUDE_STP_PARSE_HPP_
 
 #include "exports.hpp"
+#include "options.hpp"
+#include "topology.hpp"
 
 #include <gm/shell.hpp>
 
+#include <functional>
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace stp {
-STP_EXPORT std::vector<gm::Shell> parse(const std::string& str);
-STP_EXPORT std::vector<gm::Shell> parse(std::istream& is);
+using shell_callback_t = std::function<void(gm::Shell&&)>;
+
+STP_EXPORT std::vector<gm::Shell> parse(const std::string& str,
+                                        const Options& options = Options());
+STP_EXPORT std::vector<gm::Shell> parse(std::istream& is,
+                                        const Options& options = Options());
+
+// Parses a file already in memory. The buffer is read in place and only
+// needs to stay valid for the duration of the call.
+STP_EXPORT std::vector<gm::Shell>
+parse_buffer(std::string_view data, const Options& options = Options());
+STP_EXPORT std::vector<gm::Shell>
+parse_buffer(const char* data, size_t size,
+             const Options& options = Options());
+
+// Hands every shell to callback as soon as it is built, so the caller can
+// process a file without holding all of its shells at once.
+STP_EXPORT void parse_each(const std::string& str,
+                           const shell_callback_t& callback,
+                           const Options& options = Options());
+STP_EXPORT void parse_each(std::istream& is, const shell_callback_t& callback,
+                           const Options& options = Options());
+STP_EXPORT void parse_each_buffer(std::string_view data,
+                                  const shell_callback_t& callback,
+                                  const Options& options = Options());
+
+// Builds the shells of a file as a topology, which keeps every vertex and
+// edge once instead of copying it into each of its uses.
+STP_EXPORT Topology parse_topology(const std::string& str,
+                                   const Options& options = Options());
+STP_EXPORT Topology parse_topology(std::istream& is,
+                                   const Options& options = Options());
+STP_EXPORT Topology parse_topology_buffer(std::string_view data,
+                                          const Options& options = Options());
+
+// Snapshots hold the decoded points, curves, surfaces and topology of the
+// shells of a file in a versioned little-endian binary form; parsing one
+// builds the same shells as parsing the file, without lexing or decoding
+// any records. Writing a snapshot is never lenient and throws if os fails.
+// Reading a snapshot of another version or a damaged one throws, only the
+// progress of options applies to it.
+STP_EXPORT void write_snapshot(const std::string& str, std::ostream& os,
+                               const Options& options = Options());
+STP_EXPORT std::vector<gm::Shell>
+parse_snapshot(const std::string& str, const Options& options = Options());
+STP_EXPORT std::vector<gm::Shell>
+parse_snapshot_buffer(std::string_view data,
+                      const Options& options = Options());
 } // namespace stp
 
 #endif // STEPPARSE_INCLUDE_STP_PARSE_HPP_
@@ -0,0 +1,53 @@
+#ifndef STEPPARSE_INCLUDE_STP_PROBE_HPP_
+#define STEPPARSE_INCLUDE_STP_PROBE_HPP_
+
+#include "exports.hpp"
+
+#include <cstddef>
+#include <iostream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace stp {
+
+// What a file holds, told from its HEADER section and the keywords of its
+// records. Strings are the literals of the header without their quotes;
+// entries that are unset ($), missing or malformed are left empty.
+struct ProbeResult {
+    // FILE_DESCRIPTION
+    std::vector<std::string> description;
+    std::string implementation_level;
+    // FILE_NAME
+    std::string name;
+    std::string time_stamp;
+    std::vector<std::string> author;
+    std::vector<std::string> organization;
+    std::string preprocessor_version;
+    std::string originating_system;
+    std::string authorization;
+    // FILE_SCHEMA
+    std::vector<std::string> schemas;
+
+    // Records of the DATA section, in total and per entity keyword, complex
+    // instances as COMPLEX.
+    size_t records = 0;
+    std::map<std::string, size_t> entities;
+    // ADVANCED_BREP_SHAPE_REPRESENTATION, MANIFOLD_SOLID_BREP and
+    // ADVANCED_FACE records, as many as a parse would build roots, shells
+    // and faces from at most.
+    size_t roots = 0;
+    size_t solids = 0;
+    size_t faces = 0;
+};
+
+// Reads the header and counts the records of a file at the speed of the
+// loader's scan, without reading their attributes or building geometry.
+STP_EXPORT ProbeResult probe(const std::string& str);
+STP_EXPORT ProbeResult probe(std::istream& is);
+STP_EXPORT ProbeResult probe_buffer(std::string_view data);
+
+} // namespace stp
+
+#endif // STEPPARSE_INCLUDE_STP_PROBE_HPP_
@@ -0,0 +1,33 @@
+#ifndef STEPPARSE_INCLUDE_STP_PROGRESS_HPP_
+#define STEPPARSE_INCLUDE_STP_PROGRESS_HPP_
+
+#include "exports.hpp"
+
+#include <atomic>
+#include <cstddef>
+
+namespace stp {
+
+// How far a parse has come. Updated by the threads doing the work when
+// passed in Options::progress and readable from any thread meanwhile.
+// Totals are set as soon as they are known and are 0 until then.
+struct STP_EXPORT ParseProgress {
+    std::atomic<size_t> bytes_total {0};
+    std::atomic<size_t> bytes_loaded {0};
+    std::atomic<size_t> shells_total {0};
+    std::atomic<size_t> shells_built {0};
+    std::atomic<size_t> faces_total {0};
+    std::atomic<size_t> faces_built {0};
+
+    // Makes the parse throw before it starts on the next face, or while
+    // indexing, from any thread.
+    void cancel() noexcept;
+    bool cancelled() const noexcept;
+
+private:
+    std::atomic<bool> cancelled_ {false};
+};
+
+} // namespace stp
+
+#endif // STEPPARSE_INCLUDE_STP_PROGRESS_HPP_
@@ -0,0 +1,58 @@
+#ifndef STEPPARSE_INCLUDE_STP_STATS_HPP_
+#define STEPPARSE_INCLUDE_STP_STATS_HPP_
+
+#include "exports.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <string>
+
+namespace stp {
+
+// Where a parse spent its time. Filled when passed in Options::stats;
+// values are added to, so one object may collect several parses. Stays
+// empty if the library was built without STP_ENABLE_STATS.
+struct STP_EXPORT ParseStats {
+    using duration_t = std::chrono::nanoseconds;
+
+    struct Cache {
+        size_t hits = 0;
+        size_t misses = 0;
+    };
+
+    // Bytes and records of the input scanned by the loader, none if the
+    // index was taken from a sidecar.
+    size_t bytes_scanned = 0;
+    size_t records_seen = 0;
+    // Records indexed per entity keyword, complex instances as COMPLEX.
+    std::map<std::string, size_t> records_kept;
+
+    // Time per stage, each excluding the stages it calls into: building a
+    // face does not count the curves, surfaces and lexing it triggers.
+    duration_t load_time {};
+    duration_t lex_time {};
+    duration_t curve_time {};
+    duration_t surface_time {};
+    duration_t face_time {};
+
+    Cache edge_cache;
+    Cache curve_cache;
+    Cache surface_cache;
+    // Points, directions, vectors, axes and vertices.
+    Cache entity_cache;
+
+    // Records read with step_read and how many of them were distinct, i.e.
+    // had to be lexed; their ratio is the number of reads per record.
+    size_t reads = 0;
+    size_t records_read = 0;
+
+    double reads_per_record() const;
+
+    // Adds the statistics of another parse to these.
+    ParseStats& operator+=(const ParseStats& other);
+};
+
+} // namespace stp
+
+#endif // STEPPARSE_INCLUDE_STP_STATS_HPP_
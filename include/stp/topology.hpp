@@ -0,0 +1,59 @@
+#ifndef STEPPARSE_INCLUDE_STP_TOPOLOGY_HPP_
+#define STEPPARSE_INCLUDE_STP_TOPOLOGY_HPP_
+
+#include "exports.hpp"
+
+#include <gm/shell.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace stp {
+
+// Use of edges[edge] in a loop, traversed against the direction of the edge
+// if orient is false.
+struct TopoUse {
+    size_t edge;
+    bool orient;
+};
+
+using TopoLoop = std::vector<TopoUse>;
+
+// Edge between vertices[begin] and vertices[end].
+struct TopoEdge {
+    std::shared_ptr<gm::AbstractCurve> curve;
+    size_t begin;
+    size_t end;
+};
+
+struct TopoFace {
+    std::shared_ptr<gm::AbstractSurface> surface;
+    bool same_sense;
+    TopoLoop outer;
+    std::vector<TopoLoop> inner;
+};
+
+struct TopoShell {
+    gm::Axis axis;
+    std::vector<TopoFace> faces;
+};
+
+// Shells of a file with every vertex and edge stored once and referred to
+// by index from all of its uses, so faces sharing an edge refer to the same
+// entry. Vertices and edges are numbered in order of first use.
+struct STP_EXPORT Topology {
+    std::vector<gm::Point> vertices;
+    std::vector<TopoEdge> edges;
+    std::vector<TopoShell> shells;
+
+    // Edge i as parse() builds it. B-spline edges end where their curve
+    // does, which may differ slightly from their vertices.
+    gm::Edge edge(size_t i) const;
+    // Shells parse() returns for the same input.
+    std::vector<gm::Shell> geom() const;
+};
+
+} // namespace stp
+
+#endif // STEPPARSE_INCLUDE_STP_TOPOLOGY_HPP_
@@ -0,0 +1,59 @@
+#ifndef STEPPARSE_INCLUDE_STP_TRACE_HPP_
+#define STEPPARSE_INCLUDE_STP_TRACE_HPP_
+
+#include "exports.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+#include <string_view>
+
+namespace stp {
+
+// A finished span of work: a loader chunk ("load"), a shell ("shell"), a
+// face ("face"), or a curve or surface that took longer than
+// Options::trace_threshold ("curve", "surface").
+struct TraceEvent {
+    using clock_t = std::chrono::steady_clock;
+
+    std::string_view category;
+    std::string_view name;
+    // STEP #id of the entity, 0 for spans not tied to one.
+    size_t id;
+    clock_t::time_point start;
+    clock_t::duration duration;
+    // Small number identifying the thread that did the work.
+    size_t thread;
+};
+
+class STP_EXPORT TraceSink {
+public:
+    virtual ~TraceSink() = default;
+
+    // Called by the threads doing the work, possibly at the same time.
+    virtual void event(const TraceEvent& event) = 0;
+};
+
+// Writes events as a Chrome trace event JSON array, as read by
+// chrome://tracing and Perfetto. The array is closed on destruction.
+class STP_EXPORT ChromeTrace : public TraceSink {
+public:
+    ChromeTrace(const ChromeTrace&) = delete;
+    ChromeTrace& operator=(const ChromeTrace&) = delete;
+
+    explicit ChromeTrace(std::ostream& os);
+    ~ChromeTrace() override;
+
+    void event(const TraceEvent& event) override;
+
+private:
+    std::mutex mutex_;
+    std::ostream& os_;
+    TraceEvent::clock_t::time_point epoch_;
+    bool first_;
+};
+
+} // namespace stp
+
+#endif // STEPPARSE_INCLUDE_STP_TRACE_HPP_
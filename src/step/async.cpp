@@ -0,0 +1,113 @@
+#include <stp/async.hpp>
+#include <util/mapped_file.hpp>
+
+#include "step_loader.hpp"
+#include "step_parser.hpp"
+
+#include <future>
+#include <memory>
+#include <thread>
+#include <utility>
+
+using namespace std;
+
+namespace stp {
+
+void ParseProgress::cancel() noexcept
+{
+    cancelled_.store(true, memory_order_relaxed);
+}
+
+bool ParseProgress::cancelled() const noexcept
+{
+    return cancelled_.load(memory_order_relaxed);
+}
+
+struct ParseTask::State {
+    ParseProgress progress;
+    future<vector<gm::Shell>> result;
+    thread worker;
+};
+
+ParseTask::ParseTask(unique_ptr<State> state)
+    : state_(move(state))
+{
+}
+
+ParseTask::ParseTask(ParseTask&&) noexcept = default;
+
+ParseTask& ParseTask::operator=(ParseTask&& other) noexcept
+{
+    if (this != &other) {
+        ParseTask old(move(*this));
+        state_ = move(other.state_);
+    }
+    return *this;
+}
+
+ParseTask::~ParseTask()
+{
+    if (!state_)
+        return;
+    if (state_->result.valid())
+        cancel();
+    if (state_->worker.joinable())
+        state_->worker.join();
+}
+
+const ParseProgress& ParseTask::progress() const
+{
+    return state_->progress;
+}
+
+void ParseTask::cancel() noexcept
+{
+    state_->progress.cancel();
+}
+
+bool ParseTask::ready() const
+{
+    return wait_for(chrono::milliseconds(0));
+}
+
+void ParseTask::wait() const
+{
+    state_->result.wait();
+}
+
+bool ParseTask::wait_for(chrono::milliseconds timeout) const
+{
+    return state_->result.wait_for(timeout) == future_status::ready;
+}
+
+vector<gm::Shell> ParseTask::get()
+{
+    return state_->result.get();
+}
+
+ParseTask parse_async(const string& str, const Options& options)
+{
+    auto state = make_unique<ParseTask::State>();
+    auto task_options = options;
+    task_options.progress = &state->progress;
+
+    promise<vector<gm::Shell>> result;
+    state->result = result.get_future();
+    // the result is set before the caches of the parser are freed, which
+    // for large files takes longer than stopping at the next face
+    auto run = [str, task_options, result = move(result)]() mutable {
+        unique_ptr<StepLoader> load;
+        unique_ptr<StepParser> parser;
+        try {
+            load = make_unique<StepLoader>(MappedFile(str), task_options);
+            parser = make_unique<StepParser>(*load, task_options);
+            result.set_value(parser->parse().take_geom());
+        } catch (...) {
+            result.set_exception(current_exception());
+        }
+    };
+    state->worker = thread(move(run));
+    return ParseTask(move(state));
+}
+
+} // namespace stp
@@ -0,0 +1,195 @@
+#include <stp/batch.hpp>
+#include <util/mapped_file.hpp>
+#include <util/thread_pool.hpp>
+
+#include "step_loader.hpp"
+#include "step_parser.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <numeric>
+#include <utility>
+
+using namespace std;
+
+namespace stp {
+
+struct BatchParser::Impl {
+    explicit Impl(size_t threads)
+        : pool(threads)
+    {
+    }
+
+    ThreadPool pool;
+};
+
+namespace {
+
+struct BatchState {
+    // files submitted and not yet done
+    size_t running = 0;
+    deque<BatchResult> done;
+    std::mutex mutex;
+    condition_variable cv;
+};
+
+double per_second(size_t count, chrono::nanoseconds time)
+{
+    auto seconds = chrono::duration<double>(time).count();
+    return seconds > 0 ? double(count) / seconds : 0.;
+}
+
+// Parses a file on the calling thread, or also on pool if pool is not null.
+BatchResult parse_file(const string& path, const Options& options,
+                       ThreadPool* pool)
+{
+    auto start = chrono::steady_clock::now();
+    BatchResult result;
+    result.path = path;
+    // files run at the same time, each reports into its own result
+    auto file_options = options;
+    if (options.diagnostics)
+        file_options.diagnostics = &result.diagnostics;
+    try {
+        MappedFile file(path);
+        result.bytes = file.size();
+        StepLoader load(move(file), file_options, pool);
+        result.shells
+            = StepParser(load, file_options, pool).parse().take_geom();
+    } catch (...) {
+        result.shells.clear();
+        result.error = current_exception();
+    }
+    result.time = chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now() - start);
+    return result;
+}
+
+} // namespace
+
+double BatchStats::files_per_second() const
+{
+    return per_second(files, time);
+}
+
+double BatchStats::bytes_per_second() const
+{
+    return per_second(bytes, time);
+}
+
+BatchParser::BatchParser(size_t threads)
+    : impl_(make_unique<Impl>(threads))
+{
+}
+
+BatchParser::~BatchParser() = default;
+
+size_t BatchParser::threads() const
+{
+    return impl_->pool.size();
+}
+
+BatchStats BatchParser::parse(const vector<string>& paths,
+                              const batch_callback_t& callback,
+                              const Options& options)
+{
+    auto start = chrono::steady_clock::now();
+    auto& pool = impl_->pool;
+    auto state = make_shared<BatchState>();
+
+    vector<size_t> sizes(paths.size());
+    for (size_t i = 0; i < paths.size(); ++i) {
+        error_code ec;
+        auto size = filesystem::file_size(paths[i], ec);
+        sizes[i] = ec ? 0 : size_t(size);
+    }
+    // indices of the files, largest first
+    vector<size_t> order(paths.size());
+    iota(begin(order), end(order), size_t(0));
+    stable_sort(begin(order), end(order),
+                [&](size_t a, size_t b) { return sizes[a] > sizes[b]; });
+
+    auto total = accumulate(begin(sizes), end(sizes), size_t(0));
+    auto split = max(total / pool.size(), StepLoader::min_chunk_size);
+
+    // each file runs on one thread, the pool only comes in for files that
+    // are split, so that small files do not pay for scheduling
+    auto file_options = options;
+    file_options.load_threads = 1;
+    file_options.parse_threads = 1;
+
+    // One task per file, submitted from here as files finish rather than
+    // all up front: a worker done with a file finds its own deque empty and
+    // steals the loader chunks and faces of split files before it starts
+    // another file.
+    size_t next = 0;
+    auto submit = [&] {
+        auto file = order[next++];
+        auto file_pool = sizes[file] >= split ? &pool : nullptr;
+        ++state->running;
+        pool.submit([state, &paths, &options, file_options, file,
+                     file_pool]() mutable {
+            ParseStats stats;
+            if (options.stats)
+                file_options.stats = &stats;
+            auto result = parse_file(paths[file], file_options, file_pool);
+
+            lock_guard<std::mutex> lock(state->mutex);
+            if (options.stats)
+                *options.stats += stats;
+            state->done.emplace_back(move(result));
+            --state->running;
+            state->cv.notify_one();
+        });
+    };
+
+    BatchStats result;
+    exception_ptr error;
+    unique_lock<std::mutex> lock(state->mutex);
+    while (next < paths.size() && state->running < pool.size())
+        submit();
+    for (;;) {
+        state->cv.wait(lock, [&] {
+            return !state->done.empty() || state->running == 0;
+        });
+        if (state->done.empty())
+            break;
+
+        auto file = move(state->done.front());
+        state->done.pop_front();
+        ++result.files;
+        result.failed += file.error ? 1 : 0;
+        result.bytes += file.bytes;
+        if (error)
+            continue;
+        if (next < paths.size())
+            submit();
+
+        lock.unlock();
+        try {
+            callback(move(file));
+        } catch (...) {
+            error = current_exception();
+        }
+        lock.lock();
+    }
+    lock.unlock();
+
+    result.time = chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now() - start);
+    if (error)
+        rethrow_exception(error);
+    return result;
+}
+
+BatchStats parse_batch(const vector<string>& paths,
+                       const batch_callback_t& callback,
+                       const Options& options)
+{
+    return BatchParser().parse(paths, callback, options);
+}
+
+} // namespace stp
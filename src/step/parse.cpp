@@ -1,23 +1,105 @@
 #include <stp/parse.hpp>
+#include <util/mapped_file.hpp>
 
 #include "step_loader.hpp"
 #include "step_parser.hpp"
-
-#include <fstream>
+#include "step_snapshot.hpp"
 
 namespace stp {
 
-std::vector<gm::Shell> parse(std::istream& is)
+namespace {
+
+std::vector<gm::Shell> parse_loaded(const StepLoader& load,
+                                    const Options& options)
+{
+    StepParser parse(load, options);
+    return parse.parse().take_geom();
+}
+
+void parse_each_loaded(const StepLoader& load,
+                       const shell_callback_t& callback,
+                       const Options& options)
+{
+    StepParser(load, options).parse_each(callback);
+}
+
+} // namespace
+
+std::vector<gm::Shell> parse(std::istream& is, const Options& options)
+{
+    return parse_loaded(StepLoader(is, options), options);
+}
+
+std::vector<gm::Shell> parse(const std::string& str, const Options& options)
+{
+    return parse_loaded(StepLoader(MappedFile(str), options), options);
+}
+
+std::vector<gm::Shell> parse_buffer(std::string_view data,
+                                    const Options& options)
+{
+    return parse_loaded(StepLoader(data, options), options);
+}
+
+std::vector<gm::Shell> parse_buffer(const char* data, size_t size,
+                                    const Options& options)
+{
+    return parse_buffer(std::string_view(data, size), options);
+}
+
+void parse_each(std::istream& is, const shell_callback_t& callback,
+                const Options& options)
+{
+    parse_each_loaded(StepLoader(is, options), callback, options);
+}
+
+void parse_each(const std::string& str, const shell_callback_t& callback,
+                const Options& options)
+{
+    parse_each_loaded(StepLoader(MappedFile(str), options), callback,
+                      options);
+}
+
+void parse_each_buffer(std::string_view data,
+                       const shell_callback_t& callback,
+                       const Options& options)
+{
+    parse_each_loaded(StepLoader(data, options), callback, options);
+}
+
+Topology parse_topology(const std::string& str, const Options& options)
+{
+    return StepParser(StepLoader(MappedFile(str), options), options)
+        .topology();
+}
+
+Topology parse_topology(std::istream& is, const Options& options)
+{
+    return StepParser(StepLoader(is, options), options).topology();
+}
+
+Topology parse_topology_buffer(std::string_view data, const Options& options)
+{
+    return StepParser(StepLoader(data, options), options).topology();
+}
+
+void write_snapshot(const std::string& str, std::ostream& os,
+                    const Options& options)
+{
+    StepSnapshot(StepLoader(MappedFile(str), options), options).write(os);
+}
+
+std::vector<gm::Shell> parse_snapshot(const std::string& str,
+                                      const Options& options)
 {
-    StepLoader load(is);
-    StepParser parse(load);
-    return parse.parse().geom();
+    MappedFile file(str);
+    return parse_snapshot_buffer(file.view(), options);
 }
 
-std::vector<gm::Shell> parse(const std::string& str)
+std::vector<gm::Shell> parse_snapshot_buffer(std::string_view data,
+                                             const Options& options)
 {
-    std::fstream is(str, std::ios_base::in);
-    return parse(is);
+    return StepSnapshot(data).take_topology(options.progress).geom();
 }
 
-} // namespace stp
\ No newline at end of file
+} // namespace stp
@@ -0,0 +1,152 @@
+#include <stp/probe.hpp>
+#include <util/mapped_file.hpp>
+
+#include "step_entities.hpp"
+#include "step_loader.hpp"
+#include "step_reader.hpp"
+#include "step_scanner.hpp"
+#include "step_tokenizer.hpp"
+
+#include <array>
+#include <iterator>
+#include <unordered_map>
+
+using namespace std;
+
+namespace stp {
+
+namespace {
+
+using str_list_ = list_<str_>;
+
+// Text of a string literal without its quotes and with doubled quotes
+// undone, empty for anything else such as $.
+string unquote(string_view literal)
+{
+    string result;
+    if (literal.size() < 2 || literal.front() != '\'')
+        return result;
+    literal = literal.substr(1, literal.size() - 2);
+    result.reserve(literal.size());
+    for (size_t i = 0; i < literal.size(); ++i) {
+        result += literal[i];
+        if (literal[i] == '\'' && i + 1 < literal.size()
+            && literal[i + 1] == '\'')
+            ++i;
+    }
+    return result;
+}
+
+vector<string> unquote(const vector<string_view>& literals)
+{
+    vector<string> result;
+    result.reserve(literals.size());
+    for (auto i : literals)
+        result.emplace_back(unquote(i));
+    return result;
+}
+
+string_view keyword(string_view record)
+{
+    size_t i = 0;
+    while (i < record.size()
+           && StepTokenizer::chars.is(record[i], CharTable::WORD))
+        ++i;
+    return record.substr(0, i);
+}
+
+// Fills the fields of result a header record holds, the header is small
+// enough to be read with the usual readers.
+void read_header(string_view record, ProbeResult& result)
+{
+    auto type = keyword(record);
+    try {
+        if (type == "FILE_DESCRIPTION") {
+            auto [description, level]
+                = step_read<i_<str_>, br_<str_list_, str_>>(record);
+            result.description = unquote(description);
+            result.implementation_level = unquote(level);
+        } else if (type == "FILE_NAME") {
+            auto [name, time_stamp, author, organization, version, system,
+                  authorization]
+                = step_read<i_<str_>,
+                            br_<str_, str_, str_list_, str_list_, str_,
+                                str_, str_>>(record);
+            result.name = unquote(name);
+            result.time_stamp = unquote(time_stamp);
+            result.author = unquote(author);
+            result.organization = unquote(organization);
+            result.preprocessor_version = unquote(version);
+            result.originating_system = unquote(system);
+            result.authorization = unquote(authorization);
+        } else if (type == "FILE_SCHEMA") {
+            auto [schemas] = step_read<i_<str_>, br_<str_list_>>(record);
+            result.schemas = unquote(schemas);
+        }
+    } catch (const err::unexpected_symbol&) {
+        // the fields of a malformed record stay empty
+    }
+}
+
+ProbeResult probe_input(string_view input)
+{
+    ProbeResult result;
+    StepScanner scanner(input);
+
+    while (!scanner.eof()) {
+        auto record = scanner.next();
+        if (record == "DATA")
+            break;
+        read_header(record, result);
+    }
+
+    // keywords the parser knows are told apart by the classifier alone,
+    // only the others are counted by name
+    array<size_t, size_t(last_entity) + 1> known {};
+    unordered_map<string_view, size_t> other;
+    while (!scanner.eof()) {
+        StepString str(scanner.next());
+        if (str == "ENDSEC")
+            break;
+        ++result.records;
+        auto name = str.cut().entity_name();
+        auto type = find_entity(name);
+        if (type != StepEntity::UNKNOWN)
+            ++known[size_t(type)];
+        else if (!name.empty())
+            ++other[name];
+    }
+
+    for (size_t i = 0; i < known.size(); ++i)
+        if (known[i])
+            result.entities[string(entity_keyword(StepEntity(i)))]
+                = known[i];
+    for (auto& [name, count] : other)
+        result.entities[string(name)] = count;
+    result.roots
+        = known[size_t(StepEntity::ADVANCED_BREP_SHAPE_REPRESENTATION)];
+    result.solids = known[size_t(StepEntity::MANIFOLD_SOLID_BREP)];
+    result.faces = known[size_t(StepEntity::ADVANCED_FACE)];
+    return result;
+}
+
+} // namespace
+
+ProbeResult probe(const string& str)
+{
+    MappedFile file(str);
+    return probe_input(file.view());
+}
+
+ProbeResult probe(istream& is)
+{
+    string buffer(istreambuf_iterator<char>(is), {});
+    return probe_input(buffer);
+}
+
+ProbeResult probe_buffer(string_view data)
+{
+    return probe_input(data);
+}
+
+} // namespace stp
@@ -1,60 +1,176 @@
 #include "step_entities.hpp"
 
-#include <map>
-#include <set>
+#include <array>
 
 using namespace std;
 
-optional<StepCurve> find_curve(const string& str)
-{
-    static const map<string, StepCurve> curves {
-        {"LINE", StepCurve::LINE},
-        {"CIRCLE", StepCurve::CIRCLE},
-        {"ELLIPSE", StepCurve::ELLIPSE},
-        {"HYPERBOLA", StepCurve::HYPERBOLA},
-        {"PARABOLA", StepCurve::PARABOLA},
-        {"B_SPLINE_CURVE_WITH_KNOTS", StepCurve::B_SPLINE_CURVE_WITH_KNOTS},
-        {"(", StepCurve::RATIONAL_B_SPLINE_CURVE}};
-    auto it = curves.find(str);
-    return it != curves.cend() ? optional<StepCurve> {it->second} : nullopt;
-}
-
-optional<StepSurface> find_surface(const string& str)
-{
-    static const map<string, StepSurface> surfaces {
-        {"PLANE", StepSurface::PLANE},
-        {"CYLINDRICAL_SURFACE", StepSurface::CYLINDRICAL_SURFACE},
-        {"CONICAL_SURFACE", StepSurface::CONICAL_SURFACE},
-        {"SPHERICAL_SURFACE", StepSurface::SPHERICAL_SURFACE},
-        {"TOROIDAL_SURFACE", StepSurface::TOROIDAL_SURFACE},
-        {"B_SPLINE_SURFACE_WITH_KNOTS",
-         StepSurface::B_SPLINE_SURFACE_WITH_KNOTS},
-        {"(", StepSurface::RATIONAL_B_SPLINE_SURFACE}};
-    auto it = surfaces.find(str);
-    return it != surfaces.cend() ? optional<StepSurface> {it->second}
-                                 : nullopt;
-}
-
-bool is_whitelisted(const string& str)
-{
-    static const set<string> whitelist = {
-        // root
-        step_root, "MANIFOLD_SOLID_BREP",
-        // geometry
-        "CARTESIAN_POINT", "VECTOR", "DIRECTION", "AXIS2_PLACEMENT_3D",
-        "AXIS2_PLACEMENT_2D",
-        // curves
-        "LINE", "CIRCLE", "ELLIPSE", "HYPERBOLA", "PARABOLA",
-        "CIRCULAR_INVOLUTE", "B_SPLINE_CURVE_WITH_KNOTS",
-        // surfaces
-        "PLANE", "CYLINDRICAL_SURFACE", "CONICAL_SURFACE", "SPHERICAL_SURFACE",
-        "TOROIDAL_SURFACE", "B_SPLINE_SURFACE_WITH_KNOTS",
-        // topology
-        "VERTEX_POINT", "EDGE_CURVE", "ORIENTED_EDGE", "EDGE_LOOP",
-        "OPEN_PATH", "ORIENTED_PATH", "FACE_BOUND", "FACE_OUTER_BOUND",
-        "FACE_SURFACE", "ADVANCED_FACE", "CLOSED_SHELL",
-        "ORIENTED_CLOSED_SHELL", "OPEN_SHELL", "ORIENTED_OPEN_SHELL",
-        // stuff
-        "("};
-    return whitelist.find(str) != whitelist.cend();
+namespace {
+
+struct Keyword {
+    string_view name;
+    StepEntity type;
+};
+
+constexpr Keyword keywords[] = {
+    {"(", StepEntity::COMPLEX},
+    // root
+    {"ADVANCED_BREP_SHAPE_REPRESENTATION",
+     StepEntity::ADVANCED_BREP_SHAPE_REPRESENTATION},
+    {"MANIFOLD_SOLID_BREP", StepEntity::MANIFOLD_SOLID_BREP},
+    // geometry
+    {"CARTESIAN_POINT", StepEntity::CARTESIAN_POINT},
+    {"VECTOR", StepEntity::VECTOR},
+    {"DIRECTION", StepEntity::DIRECTION},
+    {"AXIS2_PLACEMENT_3D", StepEntity::AXIS2_PLACEMENT_3D},
+    {"AXIS2_PLACEMENT_2D", StepEntity::AXIS2_PLACEMENT_2D},
+    // curves
+    {"LINE", StepEntity::LINE},
+    {"CIRCLE", StepEntity::CIRCLE},
+    {"ELLIPSE", StepEntity::ELLIPSE},
+    {"HYPERBOLA", StepEntity::HYPERBOLA},
+    {"PARABOLA", StepEntity::PARABOLA},
+    {"CIRCULAR_INVOLUTE", StepEntity::CIRCULAR_INVOLUTE},
+    {"B_SPLINE_CURVE_WITH_KNOTS", StepEntity::B_SPLINE_CURVE_WITH_KNOTS},
+    // surfaces
+    {"PLANE", StepEntity::PLANE},
+    {"CYLINDRICAL_SURFACE", StepEntity::CYLINDRICAL_SURFACE},
+    {"CONICAL_SURFACE", StepEntity::CONICAL_SURFACE},
+    {"SPHERICAL_SURFACE", StepEntity::SPHERICAL_SURFACE},
+    {"TOROIDAL_SURFACE", StepEntity::TOROIDAL_SURFACE},
+    {"B_SPLINE_SURFACE_WITH_KNOTS", StepEntity::B_SPLINE_SURFACE_WITH_KNOTS},
+    // topology
+    {"VERTEX_POINT", StepEntity::VERTEX_POINT},
+    {"EDGE_CURVE", StepEntity::EDGE_CURVE},
+    {"ORIENTED_EDGE", StepEntity::ORIENTED_EDGE},
+    {"EDGE_LOOP", StepEntity::EDGE_LOOP},
+    {"OPEN_PATH", StepEntity::OPEN_PATH},
+    {"ORIENTED_PATH", StepEntity::ORIENTED_PATH},
+    {"FACE_BOUND", StepEntity::FACE_BOUND},
+    {"FACE_OUTER_BOUND", StepEntity::FACE_OUTER_BOUND},
+    {"FACE_SURFACE", StepEntity::FACE_SURFACE},
+    {"ADVANCED_FACE", StepEntity::ADVANCED_FACE},
+    {"CLOSED_SHELL", StepEntity::CLOSED_SHELL},
+    {"ORIENTED_CLOSED_SHELL", StepEntity::ORIENTED_CLOSED_SHELL},
+    {"OPEN_SHELL", StepEntity::OPEN_SHELL},
+    {"ORIENTED_OPEN_SHELL", StepEntity::ORIENTED_OPEN_SHELL}};
+
+constexpr size_t table_size = 256;
+
+// FNV-1a with the offset basis perturbed by seed
+constexpr uint32_t keyword_hash(string_view str, uint32_t seed)
+{
+    uint32_t result = 2166136261u ^ seed;
+    for (auto c : str) {
+        result ^= uint8_t(c);
+        result *= 16777619u;
+    }
+    return result;
+}
+
+constexpr size_t keyword_slot(string_view str, uint32_t seed)
+{
+    return keyword_hash(str, seed) % table_size;
+}
+
+constexpr bool is_perfect(uint32_t seed)
+{
+    array<bool, table_size> used {};
+    for (auto& k : keywords) {
+        auto slot = keyword_slot(k.name, seed);
+        if (used[slot])
+            return false;
+        used[slot] = true;
+    }
+    return true;
+}
+
+constexpr uint32_t find_seed()
+{
+    uint32_t seed = 0;
+    while (!is_perfect(seed))
+        ++seed;
+    return seed;
+}
+
+constexpr auto seed = find_seed();
+
+constexpr array<Keyword, table_size> make_table()
+{
+    array<Keyword, table_size> result {};
+    for (auto& k : keywords)
+        result[keyword_slot(k.name, seed)] = k;
+    return result;
+}
+
+constexpr auto table = make_table();
+
+static_assert(table[keyword_slot("EDGE_CURVE", seed)].type
+                  == StepEntity::EDGE_CURVE,
+              "keyword table is not a perfect hash");
+
+} // namespace
+
+StepEntity find_entity(string_view keyword)
+{
+    auto& entry = table[keyword_slot(keyword, seed)];
+    return entry.name == keyword ? entry.type : StepEntity::UNKNOWN;
+}
+
+string_view entity_keyword(StepEntity type)
+{
+    if (type == StepEntity::COMPLEX)
+        return "COMPLEX";
+    for (auto& k : keywords)
+        if (k.type == type)
+            return k.name;
+    return "";
+}
+
+optional<StepCurve> find_curve(StepEntity type)
+{
+    switch (type) {
+    case StepEntity::LINE:
+        return StepCurve::LINE;
+    case StepEntity::CIRCLE:
+        return StepCurve::CIRCLE;
+    case StepEntity::ELLIPSE:
+        return StepCurve::ELLIPSE;
+    case StepEntity::HYPERBOLA:
+        return StepCurve::HYPERBOLA;
+    case StepEntity::PARABOLA:
+        return StepCurve::PARABOLA;
+    case StepEntity::B_SPLINE_CURVE_WITH_KNOTS:
+        return StepCurve::B_SPLINE_CURVE_WITH_KNOTS;
+    case StepEntity::COMPLEX:
+        return StepCurve::RATIONAL_B_SPLINE_CURVE;
+    default:
+        return nullopt;
+    }
+}
+
+optional<StepSurface> find_surface(StepEntity type)
+{
+    switch (type) {
+    case StepEntity::PLANE:
+        return StepSurface::PLANE;
+    case StepEntity::CYLINDRICAL_SURFACE:
+        return StepSurface::CYLINDRICAL_SURFACE;
+    case StepEntity::CONICAL_SURFACE:
+        return StepSurface::CONICAL_SURFACE;
+    case StepEntity::SPHERICAL_SURFACE:
+        return StepSurface::SPHERICAL_SURFACE;
+    case StepEntity::TOROIDAL_SURFACE:
+        return StepSurface::TOROIDAL_SURFACE;
+    case StepEntity::B_SPLINE_SURFACE_WITH_KNOTS:
+        return StepSurface::B_SPLINE_SURFACE_WITH_KNOTS;
+    case StepEntity::COMPLEX:
+        return StepSurface::RATIONAL_B_SPLINE_SURFACE;
+    default:
+        return nullopt;
+    }
+}
+
+bool is_whitelisted(StepEntity type)
+{
+    return type != StepEntity::UNKNOWN;
 }
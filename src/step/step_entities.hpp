@@ -1,12 +1,57 @@
 #ifndef STEPPARSE_SRC_STEP_STEP_ENTITIES_HPP_
 #define STEPPARSE_SRC_STEP_STEP_ENTITIES_HPP_
 
-#include <map>
+#include <cstdint>
 #include <optional>
-#include <set>
-#include <string>
+#include <string_view>
 
-static const auto step_root = "ADVANCED_BREP_SHAPE_REPRESENTATION";
+// Entity types the parser reads. COMPLEX stands for any complex instance,
+// i.e. a record starting with '(' instead of a keyword.
+enum class StepEntity : uint8_t {
+    UNKNOWN,
+    COMPLEX,
+    // root
+    ADVANCED_BREP_SHAPE_REPRESENTATION,
+    MANIFOLD_SOLID_BREP,
+    // geometry
+    CARTESIAN_POINT,
+    VECTOR,
+    DIRECTION,
+    AXIS2_PLACEMENT_3D,
+    AXIS2_PLACEMENT_2D,
+    // curves
+    LINE,
+    CIRCLE,
+    ELLIPSE,
+    HYPERBOLA,
+    PARABOLA,
+    CIRCULAR_INVOLUTE,
+    B_SPLINE_CURVE_WITH_KNOTS,
+    // surfaces
+    PLANE,
+    CYLINDRICAL_SURFACE,
+    CONICAL_SURFACE,
+    SPHERICAL_SURFACE,
+    TOROIDAL_SURFACE,
+    B_SPLINE_SURFACE_WITH_KNOTS,
+    // topology
+    VERTEX_POINT,
+    EDGE_CURVE,
+    ORIENTED_EDGE,
+    EDGE_LOOP,
+    OPEN_PATH,
+    ORIENTED_PATH,
+    FACE_BOUND,
+    FACE_OUTER_BOUND,
+    FACE_SURFACE,
+    ADVANCED_FACE,
+    CLOSED_SHELL,
+    ORIENTED_CLOSED_SHELL,
+    OPEN_SHELL,
+    ORIENTED_OPEN_SHELL
+};
+
+constexpr auto last_entity = StepEntity::ORIENTED_OPEN_SHELL;
 
 enum class StepCurve {
     LINE,
@@ -28,8 +73,14 @@ enum class StepSurface {
     RATIONAL_B_SPLINE_SURFACE
 };
 
-std::optional<StepCurve> find_curve(const std::string& str);
-std::optional<StepSurface> find_surface(const std::string& str);
-bool is_whitelisted(const std::string& str);
+// Classifies a record keyword ("(" for complex instances) with a perfect
+// hash computed at compile time.
+StepEntity find_entity(std::string_view keyword);
+// Keyword of type, "COMPLEX" for complex instances and "" for UNKNOWN.
+std::string_view entity_keyword(StepEntity type);
+
+std::optional<StepCurve> find_curve(StepEntity type);
+std::optional<StepSurface> find_surface(StepEntity type);
+bool is_whitelisted(StepEntity type);
 
 #endif // STEPPARSE_SRC_STEP_STEP_ENTITIES_HPP_
@@ -0,0 +1,117 @@
+#include "step_geometry.hpp"
+
+using namespace std;
+
+namespace {
+
+vector<gm::Point> to_points(const vector<coords_t>& coords)
+{
+    vector<gm::Point> result;
+    result.reserve(coords.size());
+    for (auto& i : coords)
+        result.emplace_back(to_point(i));
+    return result;
+}
+
+} // namespace
+
+gm::Vec to_vec(const coords_t& coords)
+{
+    return gm::Vec(coords);
+}
+
+gm::Point to_point(const coords_t& coords)
+{
+    return gm::Point(gm::Vec(coords));
+}
+
+gm::Axis make_axis(const StepAxisData& data)
+{
+    return gm::Axis::from_zx(to_vec(data.z), to_vec(data.ref),
+                             to_point(data.center));
+}
+
+bool is_bspline(StepCurve type)
+{
+    return type == StepCurve::B_SPLINE_CURVE_WITH_KNOTS
+        || type == StepCurve::RATIONAL_B_SPLINE_CURVE;
+}
+
+bool is_bspline(StepSurface type)
+{
+    return type == StepSurface::B_SPLINE_SURFACE_WITH_KNOTS
+        || type == StepSurface::RATIONAL_B_SPLINE_SURFACE;
+}
+
+shared_ptr<gm::AbstractCurve> make_curve(StepCurveData data)
+{
+    switch (data.type) {
+    case StepCurve::LINE:
+        return make_shared<gm::Line>(data.a * unit(to_vec(data.axis.z)),
+                                     to_point(data.axis.center));
+    case StepCurve::CIRCLE:
+        return make_shared<gm::Circle>(data.a, make_axis(data.axis));
+    case StepCurve::ELLIPSE:
+        return make_shared<gm::Ellipse>(data.a, data.b, make_axis(data.axis));
+    case StepCurve::PARABOLA:
+        return make_shared<gm::Parabola>(data.a, make_axis(data.axis));
+    case StepCurve::HYPERBOLA:
+        return make_shared<gm::Hyperbola>(data.a, data.b,
+                                          make_axis(data.axis));
+    case StepCurve::B_SPLINE_CURVE_WITH_KNOTS:
+        return make_shared<gm::BSplineCurve>(data.degree, move(data.mults),
+                                             move(data.knots),
+                                             to_points(data.points));
+    case StepCurve::RATIONAL_B_SPLINE_CURVE:
+        return make_shared<gm::BSplineCurve>(
+            data.degree, move(data.mults), move(data.knots),
+            to_points(data.points), move(data.weights));
+    }
+    return nullptr;
+}
+
+shared_ptr<gm::AbstractSurface> make_surface(StepSurfaceData data)
+{
+    auto points = [&] {
+        vector<vector<gm::Point>> result;
+        result.reserve(data.points.size());
+        for (auto& row : data.points)
+            result.emplace_back(to_points(row));
+        return result;
+    };
+
+    switch (data.type) {
+    case StepSurface::PLANE:
+        return make_shared<gm::Plane>(make_axis(data.axis));
+    case StepSurface::CYLINDRICAL_SURFACE:
+        return make_shared<gm::CylindricalSurface>(data.a,
+                                                   make_axis(data.axis));
+    case StepSurface::CONICAL_SURFACE:
+        return make_shared<gm::ConicalSurface>(data.a, data.b,
+                                               make_axis(data.axis));
+    case StepSurface::SPHERICAL_SURFACE:
+        return make_shared<gm::SphericalSurface>(data.a,
+                                                 make_axis(data.axis));
+    case StepSurface::TOROIDAL_SURFACE:
+        return make_shared<gm::ToroidalSurface>(data.a, data.b,
+                                                make_axis(data.axis));
+    case StepSurface::B_SPLINE_SURFACE_WITH_KNOTS:
+        return make_shared<gm::BSplineSurface>(
+            data.udegree, data.vdegree, move(data.umults), move(data.uknots),
+            move(data.vmults), move(data.vknots), points());
+    case StepSurface::RATIONAL_B_SPLINE_SURFACE:
+        return make_shared<gm::BSplineSurface>(
+            data.udegree, data.vdegree, move(data.umults), move(data.uknots),
+            move(data.vmults), move(data.vknots), points(),
+            move(data.weights));
+    }
+    return nullptr;
+}
+
+gm::Edge make_edge(shared_ptr<gm::AbstractCurve> curve, const gm::Point& begin,
+                   const gm::Point& end)
+{
+    if (auto bspline = dynamic_cast<const gm::BSplineCurve*>(curve.get()))
+        return gm::Edge(curve, bspline->pfront(), bspline->pback());
+    return gm::Edge(move(curve), begin, end);
+}
@@ -0,0 +1,75 @@
+#ifndef STEPPARSE_SRC_STEP_STEP_GEOMETRY_HPP_
+#define STEPPARSE_SRC_STEP_STEP_GEOMETRY_HPP_
+
+#include <gm/curves.hpp>
+#include <gm/oriented_edge.hpp>
+#include <gm/surfaces.hpp>
+#include <gm/vec.hpp>
+
+#include "step_entities.hpp"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+// Decoded parameters of the entities the parser builds, kept as plain
+// numbers so that snapshots can store them and build the same objects
+// without reading the records again.
+using coords_t = std::array<double, 3>;
+
+gm::Vec to_vec(const coords_t& coords);
+gm::Point to_point(const coords_t& coords);
+
+// AXIS2_PLACEMENT_3D
+struct StepAxisData {
+    coords_t center;
+    coords_t z;
+    coords_t ref;
+};
+
+gm::Axis make_axis(const StepAxisData& data);
+
+struct StepCurveData {
+    StepCurve type;
+    // the placement of conics; a LINE keeps its location in axis.center
+    // and the direction of its VECTOR in axis.z
+    StepAxisData axis;
+    // radii, focal distance or the magnitude of a LINE
+    double a;
+    double b;
+    // B-splines only, weights only if rational
+    size_t degree;
+    std::vector<size_t> mults;
+    std::vector<double> knots;
+    std::vector<coords_t> points;
+    std::vector<double> weights;
+};
+
+struct StepSurfaceData {
+    StepSurface type;
+    StepAxisData axis;
+    // radii or the semi-angle of a cone
+    double a;
+    double b;
+    // B-splines only, weights only if rational
+    size_t udegree;
+    size_t vdegree;
+    std::vector<size_t> umults;
+    std::vector<size_t> vmults;
+    std::vector<double> uknots;
+    std::vector<double> vknots;
+    std::vector<std::vector<coords_t>> points;
+    std::vector<std::vector<double>> weights;
+};
+
+bool is_bspline(StepCurve type);
+bool is_bspline(StepSurface type);
+
+std::shared_ptr<gm::AbstractCurve> make_curve(StepCurveData data);
+std::shared_ptr<gm::AbstractSurface> make_surface(StepSurfaceData data);
+// Edge along curve between begin and end. A B-spline edge ends where its
+// curve does instead, which may differ slightly from its vertices.
+gm::Edge make_edge(std::shared_ptr<gm::AbstractCurve> curve,
+                   const gm::Point& begin, const gm::Point& end);
+
+#endif // STEPPARSE_SRC_STEP_STEP_GEOMETRY_HPP_
@@ -0,0 +1,140 @@
+#include <util/hash.hpp>
+#include <util/mapped_file.hpp>
+
+#include "step_index.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+constexpr char magic[8] = {'S', 'T', 'P', 'I', 'N', 'D', 'E', 'X'};
+constexpr uint32_t byte_order = 0x01020304;
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t input_size;
+    uint64_t input_hash;
+    uint64_t stop;
+    uint64_t max_id;
+    uint64_t count;
+};
+
+struct Entry {
+    uint64_t id;
+    uint64_t offset;
+    uint32_t length;
+    uint32_t type;
+};
+
+static_assert(sizeof(Header) == 56, "unexpected padding in index header");
+static_assert(sizeof(Entry) == 24, "unexpected padding in index entry");
+
+constexpr auto max_type = uint32_t(last_entity);
+
+} // namespace
+
+string StepIndex::path_for(const string& step_path)
+{
+    return step_path + ".stpidx";
+}
+
+bool StepIndex::read(const string& path, string_view input,
+                     StepLoader::data_t& data, size_t& stop)
+{
+    MappedFile file;
+    try {
+        file = MappedFile(path);
+    } catch (const err::file_not_mapped&) {
+        return false;
+    }
+
+    Header header;
+    if (file.size() < sizeof(header))
+        return false;
+    memcpy(&header, file.data(), sizeof(header));
+
+    if (memcmp(header.magic, magic, sizeof(magic)) != 0
+        || header.version != version || header.byte_order != byte_order
+        || header.input_size != input.size() || header.stop > input.size()
+        || header.count > (file.size() - sizeof(header)) / sizeof(Entry)
+        || file.size() != sizeof(header) + header.count * sizeof(Entry)
+        || header.input_hash != content_hash(input))
+        return false;
+
+    data.reserve(header.max_id, header.count);
+    auto p = file.data() + sizeof(header);
+    for (uint64_t i = 0; i < header.count; ++i, p += sizeof(Entry)) {
+        Entry entry;
+        memcpy(&entry, p, sizeof(entry));
+        if (entry.type == 0 || entry.type > max_type
+            || entry.offset > input.size()
+            || entry.length > input.size() - entry.offset) {
+            data.clear();
+            return false;
+        }
+        data.emplace(entry.id,
+                     StepRecord {input.substr(entry.offset, entry.length),
+                                 StepEntity(entry.type)});
+    }
+    stop = header.stop;
+    return true;
+}
+
+bool StepIndex::write(const string& path, string_view input,
+                      const StepLoader::data_t& data, size_t stop)
+{
+    Header header;
+    memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.byte_order = byte_order;
+    header.input_size = input.size();
+    header.input_hash = content_hash(input);
+    header.stop = stop;
+    header.max_id = 0;
+    header.count = data.size();
+
+    vector<Entry> entries;
+    entries.reserve(data.size());
+    bool fits = true;
+    data.for_each([&](size_t id, const StepRecord& record) {
+        auto length = record.text.size();
+        fits = fits && length <= UINT32_MAX;
+        header.max_id = max<uint64_t>(header.max_id, id);
+        entries.push_back({id, uint64_t(record.text.data() - input.data()),
+                           uint32_t(length), uint32_t(record.type)});
+    });
+    if (!fits)
+        return false;
+
+    // several processes may rebuild the same index at once
+    auto temp = path + "." + to_string(random_device()()) + ".tmp";
+    {
+        ofstream os(temp, ios::binary | ios::trunc);
+        os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        os.write(reinterpret_cast<const char*>(entries.data()),
+                 streamsize(entries.size() * sizeof(Entry)));
+        if (!os.flush()) {
+            os.close();
+            remove(temp.c_str());
+            return false;
+        }
+    }
+    // rename() does not replace an existing file on Windows
+    if (rename(temp.c_str(), path.c_str()) != 0
+        && (remove(path.c_str()), rename(temp.c_str(), path.c_str()) != 0)) {
+        remove(temp.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,34 @@
+#ifndef STEPPARSE_SRC_STEP_STEP_INDEX_HPP_
+#define STEPPARSE_SRC_STEP_STEP_INDEX_HPP_
+
+#include "step_loader.hpp"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Sidecar file caching the record index of a STEP file: offsets and lengths
+// of the whitelisted records, their entity types and a hash of the whole
+// input, so that loading the same file again skips the scan.
+// The format is native-endian and only meant for the machine that wrote it;
+// an index with a different byte order, version, input size or hash is
+// treated as missing.
+struct StepIndex {
+    // Bump whenever the layout or the numbering of StepEntity changes.
+    static constexpr uint32_t version = 1;
+
+    static std::string path_for(const std::string& step_path);
+
+    // Fills data with the records of input and sets stop to the offset
+    // following ENDSEC. Returns false, leaving data empty, if the index at
+    // path is missing, damaged or stale.
+    static bool read(const std::string& path, std::string_view input,
+                     StepLoader::data_t& data, size_t& stop);
+
+    // Writes the index atomically, so that concurrent loads of one file see
+    // either the old index or the new one. Returns false on I/O errors.
+    static bool write(const std::string& path, std::string_view input,
+                      const StepLoader::data_t& data, size_t stop);
+};
+
+#endif // STEPPARSE_SRC_STEP_STEP_INDEX_HPP_
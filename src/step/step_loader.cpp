@@ -1,70 +1,293 @@
 #include "step_loader.hpp"
-#include "step_entities.hpp"
+#include "step_index.hpp"
+#include "step_stats.hpp"
+#include "step_trace.hpp"
 #include "step_tokenizer.hpp"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cctype>
+#include <charconv>
+#include <functional>
+#include <future>
 #include <iterator>
-#include <sstream>
+#include <memory_resource>
+#include <thread>
+#include <utility>
 
 using namespace std;
 
-StepLoader::StepLoader(istream& is)
-    : is_(is)
+namespace {
+
+struct Chunk {
+    size_t first;
+    size_t last;
+    size_t stop;
+    size_t seen;
+    bool end;
+    pmr::vector<pair<size_t, StepRecord>> records;
+};
+
+constexpr size_t report_period = 4096;
+
+// Adds the bytes scanned since the last report to progress and throws if
+// the parse was cancelled.
+void report(stp::ParseProgress* progress, size_t pos, size_t& reported)
+{
+    if (!progress)
+        return;
+    progress->bytes_loaded.fetch_add(pos - reported, memory_order_relaxed);
+    reported = pos;
+    CHECK_IF(progress->cancelled(), err::parse_cancelled, "parse cancelled");
+}
+
+// Indexes records starting in [first, last), stops after ENDSEC.
+void index_chunk(string_view input, Chunk& chunk,
+                 stp::ParseProgress* progress)
 {
+    StepScanner scanner(input, chunk.first);
     StepString str;
-    string entity;
+    auto reported = chunk.first;
 
-    while (is_ && readline() != "DATA")
-        ;
-    while (is_ && (str = readline()) != "ENDSEC") {
+    while (!scanner.eof() && scanner.pos() < chunk.last) {
+        if (chunk.seen % report_period == report_period - 1)
+            report(progress, scanner.pos(), reported);
+        str = StepString(scanner.next());
+        if (str == "ENDSEC") {
+            chunk.end = true;
+            break;
+        }
+        ++chunk.seen;
         str.cut();
-        entity = str.entity_name();
-        if (is_whitelisted(entity)) {
-            data_.emplace(str.id(), str);
+        auto type = find_entity(str.entity_name());
+        if (is_whitelisted(type)) {
+            chunk.records.emplace_back(str.id(), StepRecord {str, type});
         }
     }
+    chunk.stop = scanner.pos();
+    report(progress, chunk.stop, reported);
 }
 
-StepString StepLoader::readline()
+// Splits [first, size) into at most count chunks ending right after a ';'.
+// A ';' inside a string literal or comment makes a wrong boundary, which
+// the previous chunk detects by not stopping exactly at it. Records of the
+// chunks are allocated from memory.
+vector<Chunk> split_chunks(string_view input, size_t first, size_t count,
+                           pmr::memory_resource* memory)
+{
+    vector<Chunk> result;
+    auto size = input.size();
+    auto step = (size - first) / count;
+
+    while (first < size) {
+        auto last = size;
+        if (result.size() + 1 < count) {
+            auto eol = input.find(StepLoader::eol, first + step);
+            last = eol == string_view::npos ? size : eol + 1;
+        }
+        result.push_back({first, last, first, 0, false,
+                          pmr::vector<pair<size_t, StepRecord>>(memory)});
+        first = last;
+    }
+    return result;
+}
+
+size_t thread_count(const stp::Options& options, const ThreadPool* pool,
+                    size_t size)
 {
-    char c = '\0';
-    string result;
-    while (is_.get(c) && bool(isspace(c)))
+    auto result = pool ? pool->size() + 1 : options.load_threads;
+    if (result == 0)
+        result = max<size_t>(thread::hardware_concurrency(), 1);
+    return max<size_t>(min(result, size / StepLoader::min_chunk_size), 1);
+}
+
+} // namespace
+
+StepLoader::StepLoader(istream& is, const stp::Options& options)
+    : file_()
+    , buffer_(istreambuf_iterator<char>(is), istreambuf_iterator<char>())
+    , input_(buffer_)
+    , scanner_(input_)
+    , data_()
+{
+    build(options, nullptr);
+}
+
+StepLoader::StepLoader(MappedFile file, const stp::Options& options,
+                       ThreadPool* pool)
+    : file_(move(file))
+    , buffer_()
+    , input_(file_.view())
+    , scanner_(input_)
+    , data_()
+{
+    build(options, pool);
+}
+
+StepLoader::StepLoader(string_view buffer, const stp::Options& options)
+    : file_()
+    , buffer_()
+    , input_(buffer)
+    , scanner_(input_)
+    , data_()
+{
+    build(options, nullptr);
+}
+
+void StepLoader::build(const stp::Options& options, ThreadPool* pool)
+{
+    auto timed = STP_STATS_ENABLED && options.stats;
+    auto start = timed ? chrono::steady_clock::now()
+                       : chrono::steady_clock::time_point();
+    if (options.progress)
+        options.progress->bytes_total = input_.size();
+
+    if (!options.index_cache || file_.path().empty()) {
+        load(options, pool);
+    } else {
+        auto index = StepIndex::path_for(file_.path());
+        size_t stop = 0;
+        if (StepIndex::read(index, input_, data_, stop)) {
+            scanner_ = StepScanner(input_, stop);
+        } else {
+            load(options, pool);
+            StepIndex::write(index, input_, data_, scanner_.pos());
+        }
+    }
+    // chunks indexed again or skipped thanks to the sidecar are not
+    // reported as they go
+    if (options.progress)
+        options.progress->bytes_loaded = input_.size();
+    // records are views into the mapping and fault their pages back in
+    // when the parser first reads them
+    if (options.lazy_records)
+        file_.evict();
+
+    if (timed) {
+        auto& stats = *options.stats;
+        array<size_t, size_t(last_entity) + 1> kept {};
+        data_.for_each([&](size_t, const StepRecord& record) {
+            ++kept[size_t(record.type)];
+        });
+        for (size_t i = 0; i < kept.size(); ++i)
+            if (kept[i])
+                stats.records_kept[string(entity_keyword(StepEntity(i)))]
+                    += kept[i];
+        stats.load_time += chrono::duration_cast<stp::ParseStats::duration_t>(
+            chrono::steady_clock::now() - start);
+    }
+}
+
+void StepLoader::load(const stp::Options& options, ThreadPool* pool)
+{
+    while (!scanner_.eof() && readline() != "DATA")
         ;
-    is_.putback(c);
-    getline(is_, result, eol);
-    return StepString(result);
+
+    // the records of the chunks are only kept until copied into data_
+    auto memory = options.memory_resource ? options.memory_resource
+                                          : pmr::get_default_resource();
+    auto first = scanner_.pos();
+    auto chunks = split_chunks(
+        input_, first, thread_count(options, pool, input_.size() - first),
+        memory);
+
+    auto index = [&](Chunk& chunk) {
+        TraceSpan span(options.trace, "load", "index chunk");
+        index_chunk(input_, chunk, options.progress);
+    };
+    if (chunks.size() > 1 && pool) {
+        pool->parallel_for(chunks.size(), [&](size_t i) { index(chunks[i]); });
+    } else if (chunks.size() > 1) {
+        vector<future<void>> workers;
+        for (auto& i : chunks)
+            workers.emplace_back(async(launch::async, index, ref(i)));
+        for (auto& i : workers)
+            i.get();
+    } else if (!chunks.empty()) {
+        index(chunks.front());
+    }
+
+    // a chunk that did not stop at the next one's start means that one
+    // began mid-record, so it is indexed again from where the previous one
+    // stopped, which may in turn move where it stops
+    for (size_t i = 1; i < chunks.size(); ++i) {
+        auto& prev = chunks[i - 1];
+        if (prev.end) {
+            chunks.resize(i);
+            break;
+        }
+        auto& chunk = chunks[i];
+        if (prev.stop != chunk.first) {
+            chunk.first = chunk.stop = prev.stop;
+            chunk.seen = 0;
+            chunk.records.clear();
+            index(chunk);
+        }
+    }
+
+    size_t count = 0, max_id = 0;
+    for (auto& i : chunks) {
+        count += i.records.size();
+        for (auto& j : i.records)
+            max_id = max(max_id, j.first);
+    }
+    data_.reserve(max_id, count);
+    for (auto& i : chunks)
+        for (auto& j : i.records)
+            data_.emplace(j.first, j.second);
+    scanner_
+        = StepScanner(input_, chunks.empty() ? first : chunks.back().stop);
+
+    if (STP_STATS_ENABLED && options.stats) {
+        options.stats->bytes_scanned += scanner_.pos();
+        for (auto& i : chunks)
+            options.stats->records_seen += i.seen;
+    }
+}
+
+StepString StepLoader::readline()
+{
+    return StepString(scanner_.next());
 }
 
-const map<size_t, string>& StepLoader::data() const
+const StepLoader::data_t& StepLoader::data() const
 {
     return data_;
 }
 
-StepString::StepString(size_t id, const string& str)
-    : string(str)
+string_view StepLoader::input() const
+{
+    return input_;
+}
+
+StepString::StepString(size_t id, string_view str)
+    : string_view(str)
     , id_(id)
 {
 }
 
-StepString::StepString(const string& str)
+StepString::StepString(string_view str)
     : StepString(0, str)
 {
 }
 
 StepString& StepString::cut()
 {
-    const string& str = *this;
-    size_t id, i = 0;
-    string idstr;
-    for (; !bool(isdigit(str[i])); ++i)
+    const string_view& str = *this;
+    size_t id = 0, i = 0, size = str.size();
+
+    for (; i < size && !bool(isdigit(str[i])); ++i)
+        ;
+    auto first = str.data() + i;
+    for (; i < size && bool(isdigit(str[i])); ++i)
         ;
-    for (; bool(isdigit(str[i])); ++i)
-        idstr += str[i];
-    istringstream(idstr) >> id;
+    from_chars(first, str.data() + i, id);
 
-    while (str[i++] != '=')
+    while (i < size && str[i++] != '=')
         ;
-    for (; bool(isspace(str[i])); ++i)
+    for (; i < size && bool(isspace(str[i])); ++i)
         ;
     return (*this = StepString(id, str.substr(i)));
 }
@@ -74,10 +297,16 @@ size_t StepString::id() const
     return id_;
 }
 
-string StepString::entity_name()
+string_view StepString::entity_name()
 {
     if (id_ == 0) {
         cut();
     }
-    return StepTokenizer(*this).next().get();
+    if (!empty() && front() == '(')
+        return substr(0, 1);
+
+    size_t i = 0;
+    while (i < size() && StepTokenizer::chars.is((*this)[i], CharTable::WORD))
+        ++i;
+    return substr(0, i);
 }
@@ -1,12 +1,24 @@
 #ifndef STEPPARSE_SRC_STEP_STEP_LOADER_HPP_
 #define STEPPARSE_SRC_STEP_STEP_LOADER_HPP_
 
+#include <stp/options.hpp>
+#include <util/debug.hpp>
+#include <util/id_table.hpp>
+#include <util/mapped_file.hpp>
+#include <util/thread_pool.hpp>
+
+#include "step_entities.hpp"
+#include "step_scanner.hpp"
+
+#include <charconv>
 #include <istream>
-#include <map>
 #include <string>
+#include <string_view>
 #include <vector>
 
-class StepString : public std::string {
+EXCEPT(parse_cancelled, "")
+
+class StepString : public std::string_view {
 public:
     StepString() = default;
     StepString(const StepString&) = default;
@@ -14,31 +26,81 @@ public:
     StepString& operator=(const StepString&) = default;
     StepString& operator=(StepString&&) = default;
 
-    explicit StepString(const std::string& str);
+    explicit StepString(std::string_view str);
 
     StepString& cut();
     size_t id() const;
-    std::string entity_name();
+    std::string_view entity_name();
 
 private:
-    StepString(size_t id, const std::string& str);
+    StepString(size_t id, std::string_view str);
 
     size_t id_;
 };
 
+struct StepRecord {
+    std::string_view text;
+    StepEntity type;
+};
+
+// Calls f(id) for every #id reference in the text of a record.
+template <class F>
+void for_each_ref(std::string_view text, F&& f)
+{
+    for (auto i = text.find('#'); i != std::string_view::npos;
+         i = text.find('#', i)) {
+        size_t id = 0;
+        auto first = text.data() + i + 1, last = text.data() + text.size();
+        auto [end, ec] = std::from_chars(first, last, id);
+        if (ec == std::errc())
+            f(id);
+        i = size_t(end - text.data());
+    }
+}
+
+// Indexes whitelisted records of the DATA section. Records are views into
+// the loader's input: a memory mapped file, a copy of the input stream or a
+// caller-owned buffer, so the input must outlive everything that reads the
+// loader's data().
+// Large sections may be split into chunks indexed on several threads; the
+// result is the same as indexing them in order.
 class StepLoader {
 public:
-    using data_t = std::map<size_t, std::string>;
+    using data_t = IdTable<StepRecord>;
+
+    static constexpr auto eol = StepScanner::eol;
+    static constexpr size_t min_chunk_size = size_t(1) << 20;
 
-    static constexpr auto eol = ';';
+    StepLoader(const StepLoader&) = delete;
+    StepLoader& operator=(const StepLoader&) = delete;
+
+    explicit StepLoader(std::istream& is,
+                        const stp::Options& options = stp::Options());
+    // Reuses or rebuilds the sidecar index of file if options.index_cache
+    // is set, evicts the pages of file once indexed if options.lazy_records
+    // is set. Chunks are indexed on pool instead of options.load_threads
+    // threads if pool is not null.
+    explicit StepLoader(MappedFile file,
+                        const stp::Options& options = stp::Options(),
+                        ThreadPool* pool = nullptr);
+    // Reads buffer in place, without copying it.
+    explicit StepLoader(std::string_view buffer,
+                        const stp::Options& options = stp::Options());
 
-    explicit StepLoader(std::istream& is);
     StepString readline();
 
     const data_t& data() const;
+    // Whole input the records are views into.
+    std::string_view input() const;
 
 private:
-    std::istream& is_;
+    void build(const stp::Options& options, ThreadPool* pool);
+    void load(const stp::Options& options, ThreadPool* pool);
+
+    MappedFile file_;
+    std::string buffer_;
+    std::string_view input_;
+    StepScanner scanner_;
     data_t data_;
 };
 
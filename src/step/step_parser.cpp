@@ -2,17 +2,23 @@
 #include <gm/oriented_edge.hpp>
 #include <gm/surfaces.hpp>
 #include <util/debug.hpp>
+#include <util/thread_pool.hpp>
 #include <util/to_string.hpp>
 
 #include "step_parser.hpp"
 #include "step_reader.hpp"
+#include "step_trace.hpp"
 
 #include <spdlog/common.h>
 #include <cmms/logging.hpp>
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <optional>
+#include <thread>
+#include <utility>
 
 using namespace std;
 
@@ -20,363 +26,744 @@ StepParser& StepParser::parse()
 {
     auto shell_list = get_shells();
     auto size = shell_list.size();
+    expect(shell_list);
 
     geom_.resize(size);
+    if (pool_) {
+        parse_parallel(shell_list, *pool_);
+    } else if (auto threads = thread_count(); threads > 1) {
+        ThreadPool pool(threads - 1);
+        parse_parallel(shell_list, pool);
+    } else {
+        for (size_t i = 0; i < size; ++i) {
+            log_->debug("parsing {} / {} shell", i + 1, size);
+            geom_[i] = build_shell(shell_list[i], nullptr);
+        }
+    }
+    flush_skipped();
+    if (auto s = stats())
+        s->flush();
+
+    return *this;
+}
+
+StepParser& StepParser::parse_each(const shell_callback_t& callback)
+{
+    // the arena would keep released records until the parse ends
+    if (arena_ && memory_ == arena_.get())
+        memory_ = pmr::get_default_resource();
+    auto shell_list = get_shells();
+    auto size = shell_list.size();
+    auto release = release_lists(shell_list);
+    expect(shell_list);
+
+    unique_ptr<ThreadPool> own_pool;
+    auto pool = pool_;
+    if (auto threads = thread_count(); !pool && threads > 1) {
+        own_pool = make_unique<ThreadPool>(threads - 1);
+        pool = own_pool.get();
+    }
+
     for (size_t i = 0; i < size; ++i) {
-        auto face_list = get_faces(shell_list[i].first);
-        auto fsize = face_list.size();
-        vector<gm::Face> faces;
+        log_->debug("parsing {} / {} shell", i + 1, size);
+        auto shell = build_shell(shell_list[i], pool);
+
+        // no face is being built here, so nothing refers into the caches
+        for (auto id : release[i])
+            release_id(id);
+        callback(move(shell));
+    }
+    flush_skipped();
+    if (auto s = stats())
+        s->flush();
+
+    return *this;
+}
+
+stp::Topology StepParser::topology()
+{
+    auto shell_list = get_shells();
+    expect(shell_list);
+    vector<id_list_t> face_lists;
+    for (auto& i : shell_list)
+        face_lists.emplace_back(get_faces(i.first));
+
+    unique_ptr<ThreadPool> own_pool;
+    auto pool = pool_;
+    if (auto threads = thread_count(); !pool && threads > 1) {
+        own_pool = make_unique<ThreadPool>(threads - 1);
+        pool = own_pool.get();
+    }
+    // faces refer to edges by record id until all of them are built, then
+    // edges and vertices get their indices in file order of the faces
+    auto faces = build_faces(face_lists, pool,
+                             [&](size_t id) { return get_topo_face(id); });
+
+    stp::Topology result;
+    IdTable<size_t> vertex_index, edge_index;
+    auto vertex = [&](size_t id) {
+        auto [index, inserted]
+            = vertex_index.emplace(id, result.vertices.size());
+        if (inserted)
+            result.vertices.emplace_back(get_vertex(id));
+        return *index;
+    };
+    auto renumber = [&](stp::TopoLoop& loop) {
+        for (auto& use : loop) {
+            auto [index, inserted]
+                = edge_index.emplace(use.edge, result.edges.size());
+            auto edge = *index;
+            if (inserted) {
+                auto [start_id, end_id, curve_id] = edge_refs(use.edge);
+                auto begin = vertex(start_id);
+                auto end = vertex(end_id);
+                result.edges.push_back({get_curve(curve_id), begin, end});
+            }
+            use.edge = edge;
+        }
+    };
+
+    result.shells.resize(shell_list.size());
+    for (size_t i = 0; i < shell_list.size(); ++i) {
+        auto& shell = result.shells[i];
+        shell.axis = shell_list[i].second;
+        shell.faces = move(faces[i]);
+        for (auto& face : shell.faces) {
+            renumber(face.outer);
+            for (auto& loop : face.inner)
+                renumber(loop);
+        }
+        count_built(&stp::ParseProgress::shells_built);
+    }
+    flush_skipped();
+    if (auto s = stats())
+        s->flush();
+
+    return result;
+}
+
+template <class F>
+vector<vector<invoke_result_t<F&, size_t>>>
+StepParser::build_faces(const vector<id_list_t>& face_lists, ThreadPool* pool,
+                        F&& build)
+{
+    using face_t = invoke_result_t<F&, size_t>;
+    vector<pair<size_t, size_t>> tasks;
+    for (size_t i = 0; i < face_lists.size(); ++i)
+        for (size_t j = 0; j < face_lists[i].size(); ++j)
+            tasks.emplace_back(i, j);
+
+    // faces land in slots fixed by their position in the file, so the
+    // result does not depend on which thread built what
+    vector<optional<face_t>> slots(tasks.size());
+    auto run = [&](size_t k) {
+        auto id = face_lists[tasks[k].first][tasks[k].second];
+        slots[k] = attempt_face(id, [&] { return build(id); });
+    };
+    if (pool) {
+        pool->parallel_for(tasks.size(), run);
+    } else {
+        for (size_t k = 0; k < tasks.size(); ++k)
+            run(k);
+    }
+
+    vector<vector<face_t>> result(face_lists.size());
+    for (size_t k = 0; k < tasks.size(); ++k)
+        if (slots[k])
+            result[tasks[k].first].emplace_back(move(*slots[k]));
+    return result;
+}
+
+gm::Shell StepParser::build_shell(const pair<size_t, gm::Axis>& shell,
+                                  ThreadPool* pool)
+{
+    TraceSpan span(trace_, "shell", "shell", shell.first);
+    vector<id_list_t> face_lists {get_faces(shell.first)};
+    gm::Shell result;
+
+    log_->debug("building shell #{} with {} faces", shell.first,
+                face_lists[0].size());
+    auto faces = build_faces(face_lists, pool,
+                             [&](size_t id) { return get_face(id); });
+    result.set_ax(shell.second);
+    result.set_faces(move(faces[0]));
+    count_built(&stp::ParseProgress::shells_built);
+    return result;
+}
+
+void StepParser::parse_parallel(
+    const vector<pair<size_t, gm::Axis>>& shell_list, ThreadPool& pool)
+{
+    auto size = shell_list.size();
+    vector<id_list_t> face_lists;
+    for (auto& i : shell_list)
+        face_lists.emplace_back(get_faces(i.first));
+    log_->debug("parsing {} shells on {} threads", size, pool.size() + 1);
 
-        log_->debug("parsing {} / {} shell with {} faces", i + 1, size, fsize);
+    auto faces = build_faces(face_lists, &pool,
+                             [&](size_t id) { return get_face(id); });
+    for (size_t i = 0; i < size; ++i) {
         geom_[i].set_ax(shell_list[i].second);
-        for (size_t j = 0; j < fsize; ++j) {
-            log_->debug("parsing {} / {} face", j + 1, fsize);
+        geom_[i].set_faces(move(faces[i]));
+        count_built(&stp::ParseProgress::shells_built);
+    }
+}
 
-            faces.emplace_back(get_face(face_list[j]));
+size_t StepParser::thread_count() const
+{
+    return threads_ != 0 ? threads_
+                         : max<size_t>(thread::hardware_concurrency(), 1);
+}
+
+void StepParser::expect(const vector<pair<size_t, gm::Axis>>& shell_list)
+{
+    if (!progress_)
+        return;
+    size_t faces = 0;
+    for (auto& i : shell_list)
+        faces += get_faces(i.first).size();
+    progress_->shells_total = shell_list.size();
+    progress_->faces_total = faces;
+}
+
+void StepParser::check_cancelled() const
+{
+    CHECK_IF(progress_ && progress_->cancelled(), err::parse_cancelled,
+             "parse cancelled");
+}
+
+void StepParser::count_built(
+    atomic<size_t> stp::ParseProgress::*counter) const
+{
+    if (progress_)
+        (progress_->*counter).fetch_add(1, memory_order_relaxed);
+}
+
+vector<StepParser::id_list_t> StepParser::release_lists(
+    const vector<pair<size_t, gm::Axis>>& shell_list) const
+{
+    IdTable<size_t> last_use;
+    id_list_t stack;
+
+    // every shell marks what it reaches, so each record ends up marked by
+    // the last shell that needs it
+    for (size_t i = 0; i < shell_list.size(); ++i) {
+        stack.push_back(shell_list[i].first);
+        while (!stack.empty()) {
+            auto id = stack.back();
+            stack.pop_back();
+
+            auto [use, inserted] = last_use.emplace(id, i);
+            if (!inserted) {
+                if (*use == i)
+                    continue;
+                *use = i;
+            }
+            if (auto rec = data_.find(id); rec)
+                for_each_ref(rec->text,
+                             [&](size_t ref) { stack.push_back(ref); });
         }
-        geom_[i].set_faces(move(faces));
     }
 
-    return *this;
+    vector<id_list_t> result(shell_list.size());
+    last_use.for_each([&](size_t id, size_t i) { result[i].push_back(id); });
+    return result;
 }
 
 vector<pair<size_t, gm::Axis>> StepParser::get_shells()
 {
     vector<pair<size_t, gm::Axis>> result;
-    for (auto& i : data_) {
-        StepTokenizer tok(i.second);
-        if (tok.next().get() == step_root) {
-            // ADVANCED_BREP_SHAPE_REPRESENTATION
-            auto [ref]
-                = step_read<br_<i_<str_>, rlist_, i_<ref_>>>(tok, i.first);
-            auto axis = get_axis(ref.back());
-
-            for (auto it = cbegin(ref); it != prev(cend(ref)); ++it) {
-                // MANIFOLD_SOLID_BREP
-                auto [shell_id]
-                    = step_read<i_<str_>, br_<i_<str_>, ref_>>(at(*it), *it);
-                result.emplace_back(shell_id, axis);
-            }
+    for (auto [shell_id, axis_id] : shell_refs())
+        result.emplace_back(shell_id, get_axis(axis_id));
+    return result;
+}
+
+vector<pair<size_t, size_t>> StepParser::shell_refs()
+{
+    vector<pair<size_t, size_t>> result;
+    data_.for_each([&](size_t id, const StepRecord& record) {
+        if (record.type != StepEntity::ADVANCED_BREP_SHAPE_REPRESENTATION)
+            return;
+        // ADVANCED_BREP_SHAPE_REPRESENTATION
+        auto ref = attempt(id, [&] {
+            auto [ref] = step_read<i_<str_>, br_<i_<str_>, rlist_, i_<ref_>>>(
+                tokens(id), id);
+            axis_data(ref.back());
+            return move(ref);
+        });
+        if (!ref)
+            return;
+        auto axis_id = ref->back();
+
+        for (auto it = cbegin(*ref); it != prev(cend(*ref)); ++it) {
+            // MANIFOLD_SOLID_BREP
+            auto shell_id = attempt(*it, [&] {
+                auto [shell] = step_read<i_<str_>, br_<i_<str_>, ref_>>(
+                    tokens(*it), *it);
+                return shell;
+            });
+            // a lenient parse only keeps shells whose faces can be listed
+            if (shell_id
+                && (!diagnostics_ || attempt(*shell_id, [&] {
+                       return get_faces(*shell_id);
+                   })))
+                result.emplace_back(*shell_id, axis_id);
         }
-    }
+    });
     return result;
 }
 
 StepParser::id_list_t StepParser::get_faces(size_t id)
 {
     auto [result]
-        = step_read<i_<str_>, br_<i_<str_>, list_<ref_>>>(at(id), id);
+        = step_read<i_<str_>, br_<i_<str_>, list_<ref_>>>(tokens(id), id);
     return result;
 }
 
 gm::Face StepParser::get_face(size_t id)
 {
-    gm::FaceBound outer;
+    check_cancelled();
+    StepStats::Scope scope(stats(), StepStats::FACE);
+    TraceSpan span(trace_, "face", "face", id);
+    auto refs = face_refs(id);
+    auto bound = [&](const stp::TopoLoop& loop) {
+        gm::FaceBound result;
+        for (auto& use : loop)
+            result.emplace_back(
+                gm::OrientedEdge {get_edge(use.edge), use.orient});
+        return result;
+    };
+
     vector<gm::FaceBound> inner;
-    unique_ptr<gm::AbstractSurface> surf;
+    inner.reserve(refs.inner.size());
+    for (auto& loop : refs.inner)
+        inner.emplace_back(bound(loop));
+
+    gm::Face result(get_surface(refs.surface), refs.same_sense,
+                    bound(refs.outer), move(inner));
+    count_built(&stp::ParseProgress::faces_built);
+    return result;
+}
+
+stp::TopoFace StepParser::get_topo_face(size_t id)
+{
+    check_cancelled();
+    StepStats::Scope scope(stats(), StepStats::FACE);
+    TraceSpan span(trace_, "face", "face", id);
+    auto refs = face_refs(id);
+
+    // curves are built here so that it happens on the pool
+    auto build_curves = [&](const stp::TopoLoop& loop) {
+        for (auto& use : loop)
+            get_curve(get<2>(edge_refs(use.edge)));
+    };
+    build_curves(refs.outer);
+    for (auto& loop : refs.inner)
+        build_curves(loop);
+
+    stp::TopoFace result {get_surface(refs.surface), refs.same_sense,
+                          move(refs.outer), move(refs.inner)};
+    count_built(&stp::ParseProgress::faces_built);
+    return result;
+}
+
+// bounds and oriented edges are not cached: a bound belongs to one face and
+// an oriented edge is rarely shared, so a copy would only double the memory
+// of the output
+StepParser::FaceRefs StepParser::face_refs(size_t id) const
+{
+    FaceRefs result;
+    bool has_outer = false;
 
-    auto [bounds, surf_id, same_sense]
-        = step_read<i_<str_>, br_<i_<str_>, rlist_, ref_, bool_>>(at(id), id);
+    auto [bounds, surface, same_sense]
+        = step_read<i_<str_>, br_<i_<str_>, rlist_, ref_, bool_>>(
+            tokens(id), id);
+    result.surface = surface;
+    result.same_sense = same_sense;
 
     for (auto bound_id : bounds) {
-        auto res = get_bound(bound_id);
-        if (res.second) {
-            CHECK_IF(!outer.empty(), err::unexpected_symbol,
+        // FACE_BOUND or FACE_OUTER_BOUND
+        auto [loop_id] = step_read<i_<str_>, br_<i_<str_>, ref_, i_<bool_>>>(
+            tokens(bound_id), bound_id);
+        // EDGE_LOOP
+        auto [loop] = step_read<i_<str_>, br_<i_<str_>, rlist_>>(
+            tokens(loop_id), loop_id);
+
+        stp::TopoLoop uses;
+        uses.reserve(loop.size());
+        for (auto oedge_id : loop) {
+            // ORIENTED_EDGE
+            auto [edge_id, orientation] = step_read<
+                i_<str_>, br_<i_<str_>, i_<str_>, i_<str_>, ref_, bool_>>(
+                tokens(oedge_id), oedge_id);
+            uses.push_back({edge_id, orientation});
+        }
+        if (record(bound_id).type == StepEntity::FACE_OUTER_BOUND) {
+            CHECK_IF(has_outer, err::unexpected_symbol,
                      "Non unique outer bound");
-            outer = res.first;
+            result.outer = move(uses);
+            has_outer = true;
         } else
-            inner.emplace_back(res.first);
+            result.inner.emplace_back(move(uses));
     }
-    CHECK_IF(outer.empty(), err::unexpected_symbol,
+    CHECK_IF(!has_outer || result.outer.empty(), err::unexpected_symbol,
              "Expected one outer bound");
 
-    return gm::Face(get_surface(surf_id), same_sense, outer, inner);
+    return result;
 }
 
-pair<gm::FaceBound, bool> StepParser::get_bound(size_t id)
+gm::Edge StepParser::get_edge(size_t id)
 {
-    gm::FaceBound result;
-
-    auto [entity, loop_id]
-        = step_read<str_, br_<i_<str_>, ref_, i_<bool_>>>(at(id), id);
-    auto [loop]
-        = step_read<i_<str_>, br_<i_<str_>, rlist_>>(at(loop_id), loop_id);
-
-    for (auto oedge_id : loop)
-        result.emplace_back(get_oedge(oedge_id));
-
-    return make_pair(result, bool(entity == "FACE_OUTER_BOUND"));
+    auto decode = [&] {
+        auto [start_id, end_id, curve_id] = edge_refs(id);
+        auto vbeg = get_vertex(start_id), vend = get_vertex(end_id);
+        return make_edge(get_curve(curve_id), vbeg, vend);
+    };
+    return memoize(edge_, id, StepStats::EDGE_HIT, StepStats::EDGE_MISS,
+                   decode);
 }
 
-gm::OrientedEdge StepParser::get_oedge(size_t id)
+tuple<size_t, size_t, size_t> StepParser::edge_refs(size_t id) const
 {
-    auto [edge_id, orientation]
-        = step_read<i_<str_>, br_<i_<str_>, i_<str_>, i_<str_>, ref_, bool_>>(
-            at(id), id);
-    return {get_edge(edge_id), orientation};
+    return step_read<i_<str_>, br_<i_<str_>, ref_, ref_, ref_, i_<bool_>>>(
+        tokens(id), id);
 }
 
-gm::Edge StepParser::get_edge(size_t id)
+gm::Point StepParser::get_vertex(size_t id) const
 {
-    auto it = edge_.find(id);
+    return to_point(vertex_data(id));
+}
 
-    if (it != cend(edge_)) {
-        return it->second;
-    } else {
-        auto [start_id, end_id, curve_id]
-            = step_read<i_<str_>, br_<i_<str_>, ref_, ref_, ref_, i_<bool_>>>(
-                at(id), id);
+gm::Vec StepParser::get_dir(size_t id) const
+{
+    return to_vec(point_data(id));
+}
 
-        auto vbeg = get_vertex(start_id), vend = get_vertex(end_id);
-        auto c = get_curve(curve_id);
-        if (is_curve_bspline(curve_id)) {
-            auto& bspline = dynamic_cast<gm::BSplineCurve&>(*c);
-            auto result = gm::Edge(c, bspline.pfront(), bspline.pback());
-            edge_[id] = result;
-
-            return result;
-        } else {
-            auto result = gm::Edge(c, vbeg, vend);
-            edge_[id] = result;
-
-            return result;
-        }
-    }
+gm::Point StepParser::get_point(size_t id) const
+{
+    return to_point(point_data(id));
 }
 
-gm::Point StepParser::get_vertex(size_t id) const
+gm::Axis StepParser::get_axis(size_t id) const
 {
-    auto [point_id] = step_read<i_<str_>, br_<i_<str_>, ref_>>(at(id), id);
-    return get_point(point_id);
+    return make_axis(axis_data(id));
 }
 
-gm::Vec StepParser::get_dir(size_t id) const
+coords_t StepParser::vertex_data(size_t id) const
 {
-    auto [result] = step_read<i_<str_>, br_<i_<str_>, vec_>>(at(id), id);
-    return result;
+    return memoize_entity(vertex_, id, [&] {
+        auto [point_id]
+            = step_read<i_<str_>, br_<i_<str_>, ref_>>(tokens(id), id);
+        return point_data(point_id);
+    });
 }
 
-gm::Point StepParser::get_point(size_t id) const
+// CARTESIAN_POINT and DIRECTION records have the same layout, so points
+// share the cache of directions
+coords_t StepParser::point_data(size_t id) const
 {
-    return gm::Point(get_dir(id));
+    return memoize_entity(direction_, id, [&] {
+        auto [result]
+            = step_read<i_<str_>, br_<i_<str_>, vec_>>(tokens(id), id);
+        return result;
+    });
 }
 
-gm::Vec StepParser::get_vec(size_t id) const
+StepAxisData StepParser::axis_data(size_t id) const
 {
-    auto [direction_id, magnitude]
-        = step_read<i_<str_>, br_<i_<str_>, ref_, float_>>(at(id), id);
-    return magnitude * unit(get_dir(direction_id));
+    return memoize_entity(axis_, id, [&] {
+        auto [center_id, z_id, ref_id]
+            = step_read<i_<str_>, br_<i_<str_>, ref_, ref_, ref_>>(
+                tokens(id), id);
+        return StepAxisData {point_data(center_id), point_data(z_id),
+                             point_data(ref_id)};
+    });
 }
 
-gm::Axis StepParser::get_axis(size_t id) const
+shared_ptr<gm::AbstractCurve> StepParser::get_curve(size_t id) const
 {
-    auto [center_id, z_id, ref_id]
-        = step_read<i_<str_>, br_<i_<str_>, ref_, ref_, ref_>>(at(id), id);
+    auto decode = [&] {
+        StepStats::Scope scope(stats(), StepStats::CURVE);
+        TraceSpan span(trace_, "curve", record(id).type, id,
+                       trace_threshold_);
+        return make_curve(curve_data(id));
+    };
+    auto result = memoize(curve_, id, StepStats::CURVE_HIT,
+                          StepStats::CURVE_MISS, decode);
+    CHECK_IF(!result, err::null_pointer, "returning null curve");
 
-    auto z = get_dir(z_id), ref = get_dir(ref_id);
-    auto center = get_point(center_id);
-    return gm::Axis::from_zx(z, ref, center);
+    return result;
 }
 
-shared_ptr<gm::AbstractCurve> StepParser::get_curve(size_t id) const
+shared_ptr<gm::AbstractSurface> StepParser::get_surface(size_t id) const
 {
-    shared_ptr<gm::AbstractCurve> result = nullptr;
+    auto decode = [&] {
+        StepStats::Scope scope(stats(), StepStats::SURFACE);
+        TraceSpan span(trace_, "surface", record(id).type, id,
+                       trace_threshold_);
+        return make_surface(surface_data(id));
+    };
+    auto result = memoize(surface_, id, StepStats::SURFACE_HIT,
+                          StepStats::SURFACE_MISS, decode);
+    CHECK_IF(!result, err::null_pointer, "returning null surface");
 
-    auto pos = curve_.find(id);
-    if (pos != cend(curve_)) {
-        result = pos->second;
-    } else {
-        StepTokenizer tok(at(id));
-        if (auto curve_id = find_curve(tok.next().get());
-            curve_id.has_value()) {
-            switch (*curve_id) {
-            case StepCurve::LINE: {
-                auto [c_id, dir_id]
-                    = step_read<br_<i_<str_>, ref_, ref_>>(tok, id);
-                result
-                    = make_shared<gm::Line>(get_vec(dir_id), get_point(c_id));
-                break;
-            }
-            case StepCurve::CIRCLE: {
-                auto [axis_id, rad]
-                    = step_read<br_<i_<str_>, ref_, float_>>(tok, id);
-                result = make_shared<gm::Circle>(rad, get_axis(axis_id));
-                break;
-            }
-            case StepCurve::ELLIPSE: {
-                auto [axis_id, rx, ry]
-                    = step_read<br_<i_<str_>, ref_, float_, float_>>(tok, id);
-                result = make_shared<gm::Ellipse>(rx, ry, get_axis(axis_id));
-                break;
-            }
-            case StepCurve::PARABOLA: {
-                auto [axis_id, f]
-                    = step_read<br_<i_<str_>, ref_, float_>>(tok, id);
-                result = make_shared<gm::Parabola>(f, get_axis(axis_id));
-                break;
-            }
-            case StepCurve::HYPERBOLA: {
-                auto [axis_id, rx, ry]
-                    = step_read<br_<i_<str_>, ref_, float_, float_>>(tok, id);
-                result = make_shared<gm::Hyperbola>(rx, ry, get_axis(axis_id));
-                break;
-            }
-            case StepCurve::B_SPLINE_CURVE_WITH_KNOTS: {
-                vector<gm::Point> cp;
+    return result;
+}
 
-                auto [deg, cp_ref, k_mult, k_val] = step_read<
-                    br_<i_<str_>, int_, rlist_, i_<str_, bool_, bool_>,
-                        list_<int_>, list_<float_>, i_<str_>>>(tok, id);
+StepCurveData StepParser::curve_data(size_t id) const
+{
+    auto type = find_curve(record(id).type);
+    CHECK_IF(!type, err::null_pointer, "returning null curve");
+
+    StepCurveData result {*type, {}, 0, 0, 0, {}, {}, {}, {}};
+    auto lexed = tokens(id);
+    auto tok = TokenCursor(lexed).next();
+    auto points = [&](const auto& refs) {
+        result.points.reserve(refs.size());
+        for (auto r : refs)
+            result.points.emplace_back(point_data(r));
+    };
+
+    switch (*type) {
+    case StepCurve::LINE: {
+        auto [c_id, vec_id] = step_read<br_<i_<str_>, ref_, ref_>>(tok, id);
+        // VECTOR
+        auto [dir_id, magnitude]
+            = step_read<i_<str_>, br_<i_<str_>, ref_, float_>>(
+                tokens(vec_id), vec_id);
+        result.axis.center = point_data(c_id);
+        result.axis.z = point_data(dir_id);
+        result.a = magnitude;
+        break;
+    }
+    case StepCurve::CIRCLE:
+    case StepCurve::PARABOLA: {
+        auto [axis_id, a] = step_read<br_<i_<str_>, ref_, float_>>(tok, id);
+        result.axis = axis_data(axis_id);
+        result.a = a;
+        break;
+    }
+    case StepCurve::ELLIPSE:
+    case StepCurve::HYPERBOLA: {
+        auto [axis_id, a, b]
+            = step_read<br_<i_<str_>, ref_, float_, float_>>(tok, id);
+        result.axis = axis_data(axis_id);
+        result.a = a;
+        result.b = b;
+        break;
+    }
+    case StepCurve::B_SPLINE_CURVE_WITH_KNOTS: {
+        auto [deg, cp_ref, k_mult, k_val] = step_read<
+            br_<i_<str_>, int_, rlist_, i_<str_, bool_, bool_>, list_<int_>,
+                list_<float_>, i_<str_>>>(tok, id);
+        result.degree = deg;
+        result.mults = move(k_mult);
+        result.knots = move(k_val);
+        points(cp_ref);
+        break;
+    }
+    case StepCurve::RATIONAL_B_SPLINE_CURVE: {
+        auto [deg, cp_ref, km, kv, w]
+            = step_read<i_<str_, str_, str_, str_>,
+                        br_<int_, rlist_, i_<str_, bool_, bool_>>, i_<str_>,
+                        br_<list_<int_>, list_<float_>, i_<str_>>,
+                        i_<str_, str_, str_, str_, str_, str_, str_>,
+                        br_<list_<float_>>>(tok, id);
+        result.degree = deg;
+        result.mults = move(km);
+        result.knots = move(kv);
+        result.weights = move(w);
+        points(cp_ref);
+        break;
+    }
+    }
+    return result;
+}
 
-                for (auto r : cp_ref)
-                    cp.emplace_back(get_point(r));
-                result = make_shared<gm::BSplineCurve>(deg, k_mult, k_val, cp);
-                break;
-            }
-            case StepCurve::RATIONAL_B_SPLINE_CURVE: {
-                vector<gm::Point> cp;
-
-                auto [deg, cp_ref, km, kv, w]
-                    = step_read<i_<str_, str_, str_, str_>,
-                                br_<int_, rlist_, i_<str_, bool_, bool_>>,
-                                i_<str_>,
-                                br_<list_<int_>, list_<float_>, i_<str_>>,
-                                i_<str_, str_, str_, str_, str_, str_, str_>,
-                                br_<list_<float_>>>(tok, id);
-
-                for (auto r : cp_ref)
-                    cp.emplace_back(get_point(r));
-                result = make_shared<gm::BSplineCurve>(deg, km, kv, cp, w);
-                break;
-            }
-            }
-            curve_[id] = result;
+StepSurfaceData StepParser::surface_data(size_t id) const
+{
+    auto type = find_surface(record(id).type);
+    CHECK_IF(!type, err::null_pointer, "returning null surface");
+
+    StepSurfaceData result {*type, {}, 0, 0, 0, 0, {}, {}, {}, {}, {}, {}};
+    auto lexed = tokens(id);
+    auto tok = TokenCursor(lexed).next();
+    auto points = [&](const auto& refs) {
+        result.points.reserve(refs.size());
+        for (auto& row : refs) {
+            auto& v = result.points.emplace_back();
+            v.reserve(row.size());
+            for (auto i : row)
+                v.emplace_back(point_data(i));
         }
-    }
-    CHECK_IF(!result, err::null_pointer, "returning null curve");
+    };
 
-    log_->debug("processed curve: {}", *result);
+    switch (*type) {
+    case StepSurface::PLANE: {
+        auto [axis_id] = step_read<br_<i_<str_>, ref_>>(tok, id);
+        result.axis = axis_data(axis_id);
+        break;
+    }
+    case StepSurface::CYLINDRICAL_SURFACE:
+    case StepSurface::SPHERICAL_SURFACE: {
+        auto [axis_id, r] = step_read<br_<i_<str_>, ref_, float_>>(tok, id);
+        result.axis = axis_data(axis_id);
+        result.a = r;
+        break;
+    }
+    case StepSurface::CONICAL_SURFACE: {
+        auto [axis_id, r, a]
+            = step_read<br_<i_<str_>, ref_, float_, float_>>(tok, id);
+        result.axis = axis_data(axis_id);
+        result.a = r;
+        result.b = a;
+        break;
+    }
+    case StepSurface::TOROIDAL_SURFACE: {
+        // major radius first, gm takes the minor one first
+        auto [axis_id, r1, r0]
+            = step_read<br_<i_<str_>, ref_, float_, float_>>(tok, id);
+        result.axis = axis_data(axis_id);
+        result.a = r0;
+        result.b = r1;
+        break;
+    }
+    case StepSurface::B_SPLINE_SURFACE_WITH_KNOTS: {
+        auto [du, dv, cp_ref, ku_mult, kv_mult, ku_val, kv_val]
+            = step_read<br_<i_<str_>, int_, int_, mat_<ref_>,
+                            i_<str_, bool_, bool_, bool_>, list_<int_>,
+                            list_<int_>, list_<float_>, list_<float_>,
+                            i_<str_>>>(tok, id);
+        result.udegree = du;
+        result.vdegree = dv;
+        result.umults = move(ku_mult);
+        result.vmults = move(kv_mult);
+        result.uknots = move(ku_val);
+        result.vknots = move(kv_val);
+        points(cp_ref);
+        break;
+    }
+    case StepSurface::RATIONAL_B_SPLINE_SURFACE: {
+        auto [du, dv, cp_ref, kum, kvm, kuv, kvv, w] = step_read<
+            i_<str_, str_, str_, str_>,
+            br_<int_, int_, mat_<ref_>, i_<str_, bool_, bool_, bool_>>,
+            i_<str_>,
+            br_<list_<int_>, list_<int_>, list_<float_>, list_<float_>,
+                i_<str_>>,
+            i_<str_, str_, str_, str_>, br_<mat_<float_>>,
+            i_<str_, str_, str_, str_, str_, str_, str_, str_>>(tok, id);
+        result.udegree = du;
+        result.vdegree = dv;
+        result.umults = move(kum);
+        result.vmults = move(kvm);
+        result.uknots = move(kuv);
+        result.vknots = move(kvv);
+        result.weights = move(w);
+        points(cp_ref);
+        break;
+    }
+    }
     return result;
 }
 
-bool StepParser::is_curve_bspline(size_t curve_id) const
+const StepRecord& StepParser::record(size_t id) const
 {
-    StepTokenizer tok(at(curve_id));
-    auto val = find_curve(tok.next().get());
-    return val.has_value()
-        && (*val == StepCurve::RATIONAL_B_SPLINE_CURVE
-            || *val == StepCurve::B_SPLINE_CURVE_WITH_KNOTS);
+    auto result = data_.find(id);
+    CHECK_IF(!result, err::id_not_loaded,
+             "id (" + to_string(id) + ") is not loaded");
+    return *result;
 }
 
-shared_ptr<gm::AbstractSurface> StepParser::get_surface(size_t id) const
+string_view StepParser::at(size_t id) const
 {
-    shared_ptr<gm::AbstractSurface> result = nullptr;
+    return record(id).text;
+}
 
-    auto pos = surface_.find(id);
-    if (pos != cend(surface_)) {
-        result = pos->second;
-    } else {
-        StepTokenizer tok(at(id));
-        if (auto surf_id = find_surface(tok.next().get());
-            surf_id.has_value()) {
-            switch (*surf_id) {
-            case StepSurface::PLANE: {
-                auto [axis_id] = step_read<br_<i_<str_>, ref_>>(tok, id);
-                result = make_shared<gm::Plane>(get_axis(axis_id));
-                break;
-            }
-            case StepSurface::CYLINDRICAL_SURFACE: {
-                auto [axis_id, r]
-                    = step_read<br_<i_<str_>, ref_, float_>>(tok, id);
-                result = make_shared<gm::CylindricalSurface>(
-                    r, get_axis(axis_id));
-                break;
-            }
-            case StepSurface::CONICAL_SURFACE: {
-                auto [axis_id, r, a]
-                    = step_read<br_<i_<str_>, ref_, float_, float_>>(tok, id);
-                result
-                    = make_shared<gm::ConicalSurface>(r, a, get_axis(axis_id));
-                break;
-            }
-            case StepSurface::SPHERICAL_SURFACE: {
-                auto [axis_id, r]
-                    = step_read<br_<i_<str_>, ref_, float_>>(tok, id);
-                result
-                    = make_shared<gm::SphericalSurface>(r, get_axis(axis_id));
-                break;
-            }
-            case StepSurface::TOROIDAL_SURFACE: {
-                auto [axis_id, r1, r0]
-                    = step_read<br_<i_<str_>, ref_, float_, float_>>(tok, id);
-                result = make_shared<gm::ToroidalSurface>(r0, r1,
-                                                          get_axis(axis_id));
-                break;
-            }
-            case StepSurface::B_SPLINE_SURFACE_WITH_KNOTS: {
-                vector<vector<gm::Point>> cp;
-                auto [du, dv, cp_ref, ku_mult, kv_mult, ku_val, kv_val]
-                    = step_read<br_<i_<str_>, int_, int_, mat_<ref_>,
-                                    i_<str_, bool_, bool_, bool_>, list_<int_>,
-                                    list_<int_>, list_<float_>, list_<float_>,
-                                    i_<str_>>>(tok, id);
-                for (auto& row : cp_ref) {
-                    vector<gm::Point> v;
-                    for (auto& i : row)
-                        v.emplace_back(get_point(i));
-                    cp.emplace_back(v);
-                }
-                result = make_shared<gm::BSplineSurface>(
-                    du, dv, ku_mult, ku_val, kv_mult, kv_val, cp);
-                break;
-            }
-            case StepSurface::RATIONAL_B_SPLINE_SURFACE: {
-                vector<vector<gm::Point>> cp;
-
-                auto [du, dv, cp_ref, kum, kvm, kuv, kvv, w] = step_read<
-                    i_<str_, str_, str_, str_>,
-                    br_<int_, int_, mat_<ref_>, i_<str_, bool_, bool_, bool_>>,
-                    i_<str_>,
-                    br_<list_<int_>, list_<int_>, list_<float_>, list_<float_>,
-                        i_<str_>>,
-                    i_<str_, str_, str_, str_>, br_<mat_<float_>>,
-                    i_<str_, str_, str_, str_, str_, str_, str_, str_>>(tok,
-                                                                        id);
-
-                for (auto& row : cp_ref) {
-                    vector<gm::Point> v;
-                    for (auto& i : row)
-                        v.emplace_back(get_point(i));
-                    cp.emplace_back(v);
-                }
-
-                result = make_shared<gm::BSplineSurface>(du, dv, kum, kuv, kvm,
-                                                         kvv, cp, w);
-            }
-            }
-            surface_[id] = result;
-        }
+StepParser::LexedRecord StepParser::tokens(size_t id) const
+{
+    // every step_read of a record starts here
+    count(StepStats::READS);
+    if (auto cached = tokens_.find(id))
+        return LexedRecord(*cached);
+    count(StepStats::LEXED);
+    StepStats::Scope scope(stats(), StepStats::LEX);
+    pmr::polymorphic_allocator<TokenList> alloc(memory_);
+    return LexedRecord(store(
+        tokens_, id,
+        shared_ptr<const TokenList>(
+            allocate_shared<TokenList>(alloc, step_lex(at(id), memory_)))));
+}
+
+void StepParser::skip(size_t id, string reason)
+{
+    stp::Diagnostic result {id, {}, stp::Diagnostic::npos, move(reason)};
+    // a missing record is skipped as well, it has no keyword or offset
+    if (auto rec = data_.find(id); rec) {
+        auto text = rec->text.data();
+        result.entity = entity_keyword(rec->type);
+        if (text >= input_.data() && text < input_.data() + input_.size())
+            result.offset = size_t(text - input_.data());
     }
-    CHECK_IF(!result, err::null_pointer, "returning null surface");
+    log_->warn("skipping #{}: {}", id, result.reason);
 
-    log_->debug("processed surface: {}", *result);
-    return result;
+    lock_guard<mutex> lock(skipped_mutex_);
+    skipped_.emplace_back(move(result));
 }
 
-const string& StepParser::at(size_t id) const
+void StepParser::flush_skipped()
 {
-    CHECK_IF(data_.find(id) == cend(data_), err::id_not_loaded,
-             "id (" + to_string(id) + ") is not loaded");
-    return data_.at(id);
+    if (!diagnostics_)
+        return;
+    lock_guard<mutex> lock(skipped_mutex_);
+    // threads skip in any order
+    stable_sort(begin(skipped_), end(skipped_), [](auto& a, auto& b) {
+        return tie(a.offset, a.id) < tie(b.offset, b.id);
+    });
+    move(begin(skipped_), end(skipped_), back_inserter(*diagnostics_));
+    skipped_.clear();
+}
+
+void StepParser::release_id(size_t id)
+{
+    auto erased = size_t(edge_.erase(id)) + curve_.erase(id)
+        + surface_.erase(id) + direction_.erase(id) + axis_.erase(id)
+        + vertex_.erase(id) + tokens_.erase(id);
+    cached_.fetch_sub(erased, memory_order_relaxed);
 }
 
-StepParser::StepParser(const StepLoader& data)
+StepParser::StepParser(const StepLoader& data, const stp::Options& options,
+                       ThreadPool* pool)
     : data_(data.data())
+    , input_(data.input())
     , geom_()
     , log_(cmms::setup_logger(logger_id))
+    , threads_(options.parse_threads)
+    , pool_(pool)
+    , stats_(STP_STATS_ENABLED && options.stats
+                 ? make_unique<StepStats>(*options.stats)
+                 : nullptr)
+    , progress_(options.progress)
+    , diagnostics_(options.diagnostics)
+    , skipped_mutex_()
+    , skipped_()
+    , trace_(options.trace)
+    , trace_threshold_(options.trace_threshold)
+    , cache_entry_limit_(options.cache_entry_limit)
+    , cached_(0)
+    // an arena would keep the entries dropped past a limit until the end
+    , arena_(options.memory_resource || options.cache_entry_limit != 0
+                 ? nullptr
+                 : make_unique<ThreadArena>())
+    , memory_(options.memory_resource
+                  ? options.memory_resource
+                  : arena_ ? arena_.get() : pmr::get_default_resource())
     , edge_()
     , curve_()
     , surface_()
+    , direction_()
+    , axis_()
+    , vertex_()
+    , tokens_()
 {
 }
 
@@ -384,3 +771,8 @@ vector<gm::Shell> StepParser::geom() const
 {
     return geom_;
 }
+
+vector<gm::Shell> StepParser::take_geom()
+{
+    return exchange(geom_, {});
+}
@@ -5,12 +5,31 @@
 #include <gm/face.hpp>
 #include <gm/oriented_edge.hpp>
 #include <gm/shell.hpp>
+#include <stp/options.hpp>
+#include <stp/topology.hpp>
+#include <tokenizer/token_cursor.hpp>
+#include <util/arena.hpp>
 #include <util/debug.hpp>
+#include <util/concurrent_id_table.hpp>
+#include <util/thread_pool.hpp>
 
 #include "step_entities.hpp"
+#include "step_geometry.hpp"
 #include "step_loader.hpp"
-
+#include "step_stats.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
 
 EXCEPT(null_pointer, "")
 EXCEPT(id_not_loaded, "")
@@ -21,43 +40,216 @@ public:
     static constexpr auto logger_id = "step_parse";
 
     using id_list_t = std::vector<size_t>;
+    using shell_callback_t = std::function<void(gm::Shell&&)>;
 
-    explicit StepParser(const StepLoader& data);
+    // Getters may be called from several threads at once; the caches they
+    // share are safe for concurrent use. Faces are built on pool instead of
+    // options.parse_threads threads if pool is not null.
+    explicit StepParser(const StepLoader& data,
+                        const stp::Options& options = stp::Options(),
+                        ThreadPool* pool = nullptr);
 
     StepParser& parse();
+    // Builds shells one at a time and hands each to callback instead of
+    // storing it in geom(). Cached entities that no later shell reaches are
+    // dropped before the callback runs.
+    StepParser& parse_each(const shell_callback_t& callback);
+    // Builds the shells as a topology sharing vertices and edges between
+    // their uses instead of storing them in geom().
+    stp::Topology topology();
+
+    // Record ids an ADVANCED_FACE is made of: its surface and the edges
+    // of its outer and inner loops with their orientation.
+    struct FaceRefs {
+        size_t surface;
+        bool same_sense;
+        stp::TopoLoop outer;
+        std::vector<stp::TopoLoop> inner;
+    };
 
     std::vector<std::pair<size_t, gm::Axis>> get_shells();
+    // MANIFOLD_SOLID_BREP and AXIS2_PLACEMENT_3D ids of every shell
+    std::vector<std::pair<size_t, size_t>> shell_refs();
     id_list_t get_faces(size_t id);
 
     gm::Face get_face(size_t id);
+    FaceRefs face_refs(size_t id) const;
 
-    std::pair<gm::FaceBound, bool> get_bound(size_t id);
-    gm::OrientedEdge get_oedge(size_t id);
     gm::Edge get_edge(size_t id);
+    // start vertex, end vertex and curve of an EDGE_CURVE
+    std::tuple<size_t, size_t, size_t> edge_refs(size_t id) const;
 
     gm::Point get_vertex(size_t id) const;
 
     gm::Vec get_dir(size_t id) const;
     gm::Point get_point(size_t id) const;
-    gm::Vec get_vec(size_t id) const;
     gm::Axis get_axis(size_t id) const;
 
     std::shared_ptr<gm::AbstractCurve> get_curve(size_t id) const;
     std::shared_ptr<gm::AbstractSurface> get_surface(size_t id) const;
-    bool is_curve_bspline(size_t curve_id) const;
+
+    // Decoded parameters the getters above build their objects from.
+    coords_t vertex_data(size_t id) const;
+    // of a CARTESIAN_POINT or a DIRECTION
+    coords_t point_data(size_t id) const;
+    StepAxisData axis_data(size_t id) const;
+    StepCurveData curve_data(size_t id) const;
+    StepSurfaceData surface_data(size_t id) const;
 
     std::vector<gm::Shell> geom() const;
+    // Moves the shells out, leaving geom() empty.
+    std::vector<gm::Shell> take_geom();
 
 private:
-    const std::string& at(size_t id) const;
+    void parse_parallel(const std::vector<std::pair<size_t, gm::Axis>>& shells,
+                        ThreadPool& pool);
+    size_t thread_count() const;
+    // Sets the totals of progress_ for the faces of shells.
+    void expect(const std::vector<std::pair<size_t, gm::Axis>>& shells);
+    // Throws parse_cancelled if the parse was cancelled.
+    void check_cancelled() const;
+    void count_built(std::atomic<size_t> stp::ParseProgress::*counter) const;
+    gm::Shell build_shell(const std::pair<size_t, gm::Axis>& shell,
+                          ThreadPool* pool);
+    // Builds build(id) for the faces of every list, on pool as well if it
+    // is not null, and returns them grouped as the lists are. Faces skipped
+    // by a lenient parse are left out.
+    template <class F>
+    std::vector<std::vector<std::invoke_result_t<F&, size_t>>>
+    build_faces(const std::vector<id_list_t>& face_lists, ThreadPool* pool,
+                F&& build);
+    stp::TopoFace get_topo_face(size_t id);
+    std::vector<id_list_t> release_lists(
+        const std::vector<std::pair<size_t, gm::Axis>>& shell_list) const;
+
+    StepStats* stats() const
+    {
+        return STP_STATS_ENABLED ? stats_.get() : nullptr;
+    }
+    void count(StepStats::Counter counter) const
+    {
+        if (auto s = stats())
+            s->add(counter);
+    }
+
+    // Caches value under id unless the entry limit is reached and returns
+    // the value cached under id, or value itself if it is not cached.
+    template <class T>
+    T store(ConcurrentIdTable<T>& cache, size_t id, T value) const
+    {
+        if (cache_entry_limit_ != 0
+            && cached_.load(std::memory_order_relaxed) >= cache_entry_limit_)
+            return value;
+        // another thread may have stored id first, it counted the entry
+        auto [result, inserted] = cache.emplace(id, std::move(value));
+        if (inserted)
+            cached_.fetch_add(1, std::memory_order_relaxed);
+        return result;
+    }
+
+    // Returns the value cached under id or stores what decode() returns,
+    // counting a hit or a miss.
+    template <class T, class F>
+    T memoize(ConcurrentIdTable<T>& cache, size_t id, StepStats::Counter hit,
+              StepStats::Counter miss, F&& decode) const
+    {
+        if (auto cached = cache.find(id); cached) {
+            count(hit);
+            return std::move(*cached);
+        }
+        count(miss);
+        return store(cache, id, decode());
+    }
+    // memoize() for the entities counted together as entity_cache
+    template <class T, class F>
+    T memoize_entity(ConcurrentIdTable<T>& cache, size_t id,
+                     F&& decode) const
+    {
+        return memoize(cache, id, StepStats::ENTITY_HIT,
+                       StepStats::ENTITY_MISS, std::forward<F>(decode));
+    }
+
+    // Returns what build() returns, or nothing if it throws while the parse
+    // is lenient, in which case record id is reported as skipped.
+    // Cancellation is never caught.
+    template <class F>
+    std::optional<std::invoke_result_t<F>> attempt(size_t id, F&& build)
+    {
+        if (!diagnostics_)
+            return build();
+        try {
+            return build();
+        } catch (const err::parse_cancelled&) {
+            throw;
+        } catch (const std::exception& ex) {
+            skip(id, ex.what());
+            return std::nullopt;
+        }
+    }
+    // attempt() for a face, which counts towards progress even if skipped.
+    template <class F>
+    auto attempt_face(size_t id, F&& build)
+    {
+        auto result = attempt(id, std::forward<F>(build));
+        if (!result)
+            count_built(&stp::ParseProgress::faces_built);
+        return result;
+    }
+    void skip(size_t id, std::string reason);
+    // Adds the records skipped so far to diagnostics_ in file order.
+    void flush_skipped();
+
+    void release_id(size_t id);
+
+    const StepRecord& record(size_t id) const;
+    std::string_view at(size_t id) const;
+
+    // Tokens of a record, kept alive by the handle when the cache is full.
+    class LexedRecord {
+    public:
+        explicit LexedRecord(std::shared_ptr<const TokenList> tokens)
+            : tokens_(std::move(tokens))
+        {
+        }
+        operator TokenCursor() const
+        {
+            return TokenCursor(*tokens_);
+        }
+
+    private:
+        std::shared_ptr<const TokenList> tokens_;
+    };
+    // Lexes record id unless its tokens are cached. Lexed records are
+    // entries like decoded ones, past the limit they are lexed on each read.
+    LexedRecord tokens(size_t id) const;
 
     const StepLoader::data_t& data_;
+    // input the records are views into
+    std::string_view input_;
     std::vector<gm::Shell> geom_;
     cmms::Logger log_;
-
-    mutable std::map<size_t, gm::Edge> edge_;
-    mutable std::map<size_t, std::shared_ptr<gm::AbstractCurve>> curve_;
-    mutable std::map<size_t, std::shared_ptr<gm::AbstractSurface>> surface_;
+    size_t threads_;
+    ThreadPool* pool_;
+    std::unique_ptr<StepStats> stats_;
+    stp::ParseProgress* progress_;
+    stp::Diagnostics* diagnostics_;
+    std::mutex skipped_mutex_;
+    stp::Diagnostics skipped_;
+    stp::TraceSink* trace_;
+    std::chrono::steady_clock::duration trace_threshold_;
+    size_t cache_entry_limit_;
+    mutable std::atomic<size_t> cached_;
+    // declared before the caches, whose contents it may hold
+    std::unique_ptr<ThreadArena> arena_;
+    std::pmr::memory_resource* memory_;
+
+    mutable ConcurrentIdTable<gm::Edge> edge_;
+    mutable ConcurrentIdTable<std::shared_ptr<gm::AbstractCurve>> curve_;
+    mutable ConcurrentIdTable<std::shared_ptr<gm::AbstractSurface>> surface_;
+    mutable ConcurrentIdTable<coords_t> direction_;
+    mutable ConcurrentIdTable<StepAxisData> axis_;
+    mutable ConcurrentIdTable<coords_t> vertex_;
+    mutable ConcurrentIdTable<std::shared_ptr<const TokenList>> tokens_;
 };
 
 #endif // STEPPARSE_SRC_STEP_STEPPARSE_HPP_
@@ -1,13 +1,17 @@
 #ifndef STEPPARSE_SRC_STEP_STEP_READER_HPP_
 #define STEPPARSE_SRC_STEP_STEP_READER_HPP_
 
-#include <gm/vec.hpp>
+#include <tokenizer/token_cursor.hpp>
 #include <util/debug.hpp>
 
 #include "step_tokenizer.hpp"
 
+#include <array>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <tuple>
+#include <type_traits>
 #include <vector>
 
 EXCEPT(unexpected_symbol, "");
@@ -17,26 +21,30 @@ struct result_type {
     using type = decltype(std::tuple_cat(typename Args::tuple_t()...));
 };
 
+// Values are moved from the reader that decodes them into the tuple
+// step_read returns, never copied.
 template <class T, class... Args>
 struct StepReader {
-    static typename result_type<T, Args...>::type exec(Tokenizer& tok)
+    static typename result_type<T, Args...>::type exec(TokenCursor& tok)
     {
+        // separate statements, tokens are read in order
         auto first = StepReader<T>::exec(tok);
         auto second = StepReader<Args...>::exec(tok);
-        return std::tuple_cat(first, second);
+        return std::tuple_cat(std::move(first), std::move(second));
     }
 };
 
 template <class T>
 struct StepReader<T> {
-    static typename result_type<T>::type exec(Tokenizer& tok)
+    static typename result_type<T>::type exec(TokenCursor& tok)
     {
         return std::make_tuple(typename T::value_t());
     }
 };
 
 template <class T, class... Args>
-typename result_type<T, Args...>::type step_read(Tokenizer& tok, size_t id = 0)
+typename result_type<T, Args...>::type step_read(TokenCursor tok,
+                                                 size_t id = 0)
 {
     try {
         return StepReader<T, Args...>::exec(tok);
@@ -47,15 +55,15 @@ typename result_type<T, Args...>::type step_read(Tokenizer& tok, size_t id = 0)
 }
 
 template <class T, class... Args>
-typename result_type<T, Args...>::type step_read(const std::string& str,
+typename result_type<T, Args...>::type step_read(std::string_view str,
                                                  size_t id = 0)
 {
-    StepTokenizer tok(str);
-    return step_read<T, Args...>(tok, id);
+    auto tokens = step_lex(str);
+    return step_read<T, Args...>(TokenCursor(tokens), id);
 };
 
 struct str_ {
-    using value_t = std::string;
+    using value_t = std::string_view;
     using tuple_t = std::tuple<value_t>;
 };
 struct ref_ {
@@ -75,12 +83,12 @@ struct float_ {
     using tuple_t = std::tuple<value_t>;
 };
 struct vec_ {
-    using value_t = gm::Vec;
+    using value_t = std::array<double, 3>;
     using tuple_t = std::tuple<value_t>;
 };
-template <class T>
+template <class T, class V = std::vector<typename T::value_t>>
 struct list_ {
-    using value_t = std::vector<typename T::value_t>;
+    using value_t = V;
     using tuple_t = std::tuple<value_t>;
 };
 template <class... Args>
@@ -93,22 +101,24 @@ struct i_ {
 };
 template <class T>
 using mat_ = list_<list_<T>>;
-using rlist_ = list_<ref_>;
+// References are only walked by the parser, so their lists are allocated
+// from the memory of the tokens they are read from.
+using rlist_ = list_<ref_, std::pmr::vector<size_t>>;
 
 template <>
 struct StepReader<str_> {
-    static typename result_type<str_>::type exec(Tokenizer& tok)
+    static typename result_type<str_>::type exec(TokenCursor& tok)
     {
-        return std::make_tuple((++tok)->to_str());
+        return std::make_tuple((++tok)->str());
     }
 };
 
 template <>
 struct StepReader<ref_> {
-    static typename result_type<ref_>::type exec(Tokenizer& tok)
+    static typename result_type<ref_>::type exec(TokenCursor& tok)
     {
         size_t result = 0;
-        if ((++tok)->to_str() == "#")
+        if ((++tok)->front() == '#')
             result = (size_t)(++tok)->to_number();
         return std::make_tuple(result);
     }
@@ -116,7 +126,7 @@ struct StepReader<ref_> {
 
 template <>
 struct StepReader<int_> {
-    static typename result_type<int_>::type exec(Tokenizer& tok)
+    static typename result_type<int_>::type exec(TokenCursor& tok)
     {
         return std::make_tuple((size_t)(++tok)->to_number());
     }
@@ -124,15 +134,15 @@ struct StepReader<int_> {
 
 template <>
 struct StepReader<bool_> {
-    static typename result_type<bool_>::type exec(Tokenizer& tok)
+    static typename result_type<bool_>::type exec(TokenCursor& tok)
     {
-        return std::make_tuple((++tok)->raw() == ".T.");
+        return std::make_tuple((++tok)->str() == ".T.");
     }
 };
 
 template <>
 struct StepReader<float_> {
-    static typename result_type<float_>::type exec(Tokenizer& tok)
+    static typename result_type<float_>::type exec(TokenCursor& tok)
     {
         return std::make_tuple((++tok)->to_number());
     }
@@ -140,34 +150,51 @@ struct StepReader<float_> {
 
 template <>
 struct StepReader<vec_> {
-    static typename result_type<vec_>::type exec(Tokenizer& tok)
+    static typename result_type<vec_>::type exec(TokenCursor& tok)
     {
         std::array<double, 3> result {};
-        CHECK_IF((++tok)->raw().front() != '(', err::unexpected_symbol);
+        CHECK_IF((++tok)->front() != '(', err::unexpected_symbol);
         for (size_t i = 0; i < 3; ++i)
             result[i] = (++tok)->to_number();
-        CHECK_IF((++tok)->raw().front() != ')', err::unexpected_symbol);
-        return std::make_tuple(gm::Vec(result));
+        CHECK_IF((++tok)->front() != ')', err::unexpected_symbol);
+        return std::make_tuple(result);
     }
 };
 
+// Tokens an element takes, to size a list before reading it.
 template <class T>
-struct StepReader<list_<T>> {
-    static typename result_type<list_<T>>::type exec(Tokenizer& tok)
+inline constexpr size_t token_width = 1;
+template <>
+inline constexpr size_t token_width<ref_> = 2;
+
+template <class T, class V>
+struct StepReader<list_<T, V>> {
+    static typename result_type<list_<T, V>>::type exec(TokenCursor& tok)
     {
-        typename list_<T>::value_t result;
-        typename T::value_t elem;
-
-        if ((++tok)->raw().front() == '(') {
-            std::tie(elem) = StepReader<T>::exec(tok);
-            while (!tok.eof() && tok->raw().front() != ')') {
-                result.emplace_back(elem);
-                std::tie(elem) = StepReader<T>::exec(tok);
+        V result = make(tok);
+
+        if ((++tok)->front() == '(') {
+            result.reserve(tok.list_size() / token_width<T>);
+            for (;;) {
+                auto [elem] = StepReader<T>::exec(tok);
+                if (tok.eof() || tok->front() == ')')
+                    break;
+                result.emplace_back(std::move(elem));
             }
-            CHECK_IF(tok->raw().front() != ')', err::unexpected_symbol);
+            CHECK_IF(tok->front() != ')', err::unexpected_symbol);
         }
 
-        return std::make_tuple(result);
+        return std::make_tuple(std::move(result));
+    }
+
+private:
+    static V make(const TokenCursor& tok)
+    {
+        using pmr_t = std::pmr::vector<typename V::value_type>;
+        if constexpr (std::is_same_v<V, pmr_t>)
+            return V(tok.resource());
+        else
+            return V();
     }
 };
 
@@ -177,38 +204,43 @@ struct StepReader<mat_<T>> {
     using elem_t = typename list_<T>::value_t;
     using vec_t = typename mat_<T>::value_t;
 
-    static typename result_type<mat_<T>>::type exec(Tokenizer& tok)
+    static typename result_type<mat_<T>>::type exec(TokenCursor& tok)
     {
         vec_t result;
-        elem_t elem;
 
-        if ((++tok)->raw().front() == '(') {
-            std::tie(elem) = StepReader<list_t>::exec(tok);
-            while (!tok.eof() && !elem.empty()) {
-                result.emplace_back(elem);
-                std::tie(elem) = StepReader<list_t>::exec(tok);
+        if ((++tok)->front() == '(') {
+            auto size = tok.list_size();
+            for (;;) {
+                auto [elem] = StepReader<list_t>::exec(tok);
+                if (tok.eof() || elem.empty())
+                    break;
+                // rows are as long as the first one, with their brackets
+                if (result.empty())
+                    result.reserve(
+                        size / (elem.size() * token_width<T> + 2));
+                result.emplace_back(std::move(elem));
             }
-            CHECK_IF(tok->raw().front() != ')', err::unexpected_symbol);
+            CHECK_IF(tok->front() != ')', err::unexpected_symbol);
         }
 
-        return std::make_tuple(result);
+        return std::make_tuple(std::move(result));
     }
 };
 
 template <class... Args>
 struct StepReader<br_<Args...>> {
-    static typename result_type<br_<Args...>>::type exec(Tokenizer& tok)
+    static typename result_type<br_<Args...>>::type exec(TokenCursor& tok)
     {
-        CHECK_IF((++tok)->raw().front() != '(', err::unexpected_symbol);
+        CHECK_IF((++tok)->front() != '(', err::unexpected_symbol);
         auto result = StepReader<Args...>::exec(tok);
-        CHECK_IF((++tok)->raw().front() != ')', err::unexpected_symbol);
+        CHECK_IF((++tok)->front() != ')', err::unexpected_symbol);
         return result;
     }
 };
 
 template <class T, class... Args>
 struct StepReader<i_<T, Args...>> {
-    static typename result_type<i_<T, Args...>>::type exec(Tokenizer& tok)
+    static typename result_type<i_<T, Args...>>::type exec(TokenCursor& tok)
     {
         StepReader<T, Args...>::exec(tok);
         return std::tuple<>();
@@ -0,0 +1,211 @@
+#include "step_scanner.hpp"
+
+#include <algorithm>
+#include <cctype>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)              \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define STP_SCAN_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(STP_SCAN_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#define STP_SCAN_AVX2
+#include <immintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+constexpr bool is_special(char c)
+{
+    return c == StepScanner::eol || c == '\'' || c == '/';
+}
+
+inline unsigned first_bit(unsigned mask)
+{
+#ifdef _MSC_VER
+    unsigned long result;
+    _BitScanForward(&result, mask);
+    return unsigned(result);
+#else
+    return unsigned(__builtin_ctz(mask));
+#endif
+}
+
+const char* find_special_scalar(const char* p, const char* end)
+{
+    for (; p != end && !is_special(*p); ++p)
+        ;
+    return p;
+}
+
+#ifdef STP_SCAN_SSE2
+const char* find_special_sse2(const char* p, const char* end)
+{
+    const auto eol = _mm_set1_epi8(StepScanner::eol);
+    const auto quote = _mm_set1_epi8('\'');
+    const auto slash = _mm_set1_epi8('/');
+
+    for (; end - p >= 16; p += 16) {
+        auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        auto hit = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(block, eol),
+                         _mm_cmpeq_epi8(block, quote)),
+            _mm_cmpeq_epi8(block, slash));
+        if (auto mask = unsigned(_mm_movemask_epi8(hit)); mask != 0)
+            return p + first_bit(mask);
+    }
+    return find_special_scalar(p, end);
+}
+#endif
+
+#ifdef STP_SCAN_AVX2
+__attribute__((target("avx2"))) const char*
+find_special_avx2(const char* p, const char* end)
+{
+    const auto eol = _mm256_set1_epi8(StepScanner::eol);
+    const auto quote = _mm256_set1_epi8('\'');
+    const auto slash = _mm256_set1_epi8('/');
+
+    for (; end - p >= 32; p += 32) {
+        auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        auto hit = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(block, eol),
+                            _mm256_cmpeq_epi8(block, quote)),
+            _mm256_cmpeq_epi8(block, slash));
+        if (auto mask = unsigned(_mm256_movemask_epi8(hit)); mask != 0)
+            return p + first_bit(mask);
+    }
+    return find_special_sse2(p, end);
+}
+#endif
+
+using find_special_t = const char* (*)(const char*, const char*);
+
+find_special_t select_find_special()
+{
+#if defined(STP_SCAN_AVX2)
+    if (__builtin_cpu_supports("avx2"))
+        return find_special_avx2;
+#endif
+#if defined(STP_SCAN_SSE2)
+    return find_special_sse2;
+#else
+    return find_special_scalar;
+#endif
+}
+
+const find_special_t find_special = select_find_special();
+
+size_t find_with(find_special_t find, string_view str, size_t pos)
+{
+    auto first = str.data(), last = first + str.size();
+    return size_t(find(first + min(pos, str.size()), last) - first);
+}
+
+} // namespace
+
+size_t find_record_special(string_view str, size_t pos)
+{
+    return find_with(find_special, str, pos);
+}
+
+bool is_scan_path_supported(ScanPath path)
+{
+    switch (path) {
+    case ScanPath::SCALAR:
+        return true;
+    case ScanPath::SSE2:
+#if defined(STP_SCAN_SSE2)
+        return true;
+#else
+        return false;
+#endif
+    case ScanPath::AVX2:
+#if defined(STP_SCAN_AVX2)
+        return bool(__builtin_cpu_supports("avx2"));
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+size_t find_record_special(string_view str, size_t pos, ScanPath path)
+{
+    switch (path) {
+#if defined(STP_SCAN_AVX2)
+    case ScanPath::AVX2:
+        return find_with(find_special_avx2, str, pos);
+#endif
+#if defined(STP_SCAN_SSE2)
+    case ScanPath::SSE2:
+        return find_with(find_special_sse2, str, pos);
+#endif
+    default:
+        return find_with(find_special_scalar, str, pos);
+    }
+}
+
+StepScanner::StepScanner(string_view input, size_t pos)
+    : input_(input)
+    , pos_(pos)
+{
+}
+
+string_view StepScanner::next()
+{
+    skip_blank();
+
+    auto size = input_.size();
+    auto first = pos_, i = pos_;
+    while ((i = find_record_special(input_, i)) < size) {
+        auto c = input_[i];
+        if (c == eol) {
+            pos_ = i + 1;
+            return input_.substr(first, i - first);
+        } else if (c == '\'') {
+            // doubled quotes inside a literal close and reopen it
+            i = input_.find('\'', i + 1);
+            i = i == string_view::npos ? size : i + 1;
+        } else if (i + 1 < size && input_[i + 1] == '*') {
+            i = input_.find("*/", i + 2);
+            i = i == string_view::npos ? size : i + 2;
+        } else {
+            ++i;
+        }
+    }
+    pos_ = size;
+    return input_.substr(first);
+}
+
+bool StepScanner::eof() const
+{
+    return pos_ >= input_.size();
+}
+
+size_t StepScanner::pos() const
+{
+    return pos_;
+}
+
+void StepScanner::skip_blank()
+{
+    auto size = input_.size();
+    while (pos_ < size) {
+        if (bool(isspace(static_cast<unsigned char>(input_[pos_])))) {
+            ++pos_;
+        } else if (input_.compare(pos_, 2, "/*") == 0) {
+            auto end = input_.find("*/", pos_ + 2);
+            pos_ = end == string_view::npos ? size : end + 2;
+        } else {
+            break;
+        }
+    }
+}
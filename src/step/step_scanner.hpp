@@ -0,0 +1,40 @@
+#ifndef STEPPARSE_SRC_STEP_STEP_SCANNER_HPP_
+#define STEPPARSE_SRC_STEP_STEP_SCANNER_HPP_
+
+#include <cstddef>
+#include <string_view>
+
+// Splits the text of a STEP physical file into records. A record ends at the
+// first ';' that is not inside a '...' string literal or a /* */ comment.
+// Whitespace and comments preceding a record are not part of it.
+class StepScanner {
+public:
+    static constexpr auto eol = ';';
+
+    explicit StepScanner(std::string_view input, size_t pos = 0);
+
+    std::string_view next();
+    bool eof() const;
+    size_t pos() const;
+
+private:
+    void skip_blank();
+
+    std::string_view input_;
+    size_t pos_;
+};
+
+// Offset of the first ';', '\'' or '/' in str at or after pos, or str.size()
+// if there is none. Uses AVX2 or SSE2 when available.
+size_t find_record_special(std::string_view str, size_t pos);
+
+// Implementations find_record_special chooses from, the fastest one the
+// CPU supports is used.
+enum class ScanPath { SCALAR, SSE2, AVX2 };
+
+// Whether path is compiled in and supported by the CPU.
+bool is_scan_path_supported(ScanPath path);
+// find_record_special with path, which must be supported.
+size_t find_record_special(std::string_view str, size_t pos, ScanPath path);
+
+#endif // STEPPARSE_SRC_STEP_STEP_SCANNER_HPP_
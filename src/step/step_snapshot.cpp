@@ -0,0 +1,545 @@
+#include <util/id_table.hpp>
+
+#include "step_parser.hpp"
+#include "step_snapshot.hpp"
+
+#include <cstring>
+#include <string>
+#include <utility>
+
+using namespace std;
+
+namespace {
+
+constexpr char magic[8] = {'S', 'T', 'P', 'S', 'N', 'A', 'P', '\0'};
+
+class Writer {
+public:
+    void bytes(const void* data, size_t size)
+    {
+        buffer_.append(static_cast<const char*>(data), size);
+    }
+
+    void u8(uint8_t x)
+    {
+        buffer_.push_back(char(x));
+    }
+
+    void u32(uint32_t x)
+    {
+        for (int i = 0; i < 4; ++i)
+            u8(uint8_t(x >> (8 * i)));
+    }
+
+    void u64(uint64_t x)
+    {
+        for (int i = 0; i < 8; ++i)
+            u8(uint8_t(x >> (8 * i)));
+    }
+
+    void f64(double x)
+    {
+        uint64_t bits;
+        memcpy(&bits, &x, sizeof(bits));
+        u64(bits);
+    }
+
+    void varint(uint64_t x)
+    {
+        for (; x >= 0x80; x >>= 7)
+            u8(uint8_t(x | 0x80));
+        u8(uint8_t(x));
+    }
+
+    void coords(const coords_t& x)
+    {
+        for (auto i : x)
+            f64(i);
+    }
+
+    void axis(const StepAxisData& x)
+    {
+        coords(x.center);
+        coords(x.z);
+        coords(x.ref);
+    }
+
+    void sizes(const vector<size_t>& x)
+    {
+        varint(x.size());
+        for (auto i : x)
+            varint(i);
+    }
+
+    void numbers(const vector<double>& x)
+    {
+        varint(x.size());
+        for (auto i : x)
+            f64(i);
+    }
+
+    void points(const vector<coords_t>& x)
+    {
+        varint(x.size());
+        for (auto& i : x)
+            coords(i);
+    }
+
+    template <class T>
+    void rows(const vector<vector<T>>& x)
+    {
+        varint(x.size());
+        for (auto& i : x) {
+            if constexpr (is_same_v<T, double>)
+                numbers(i);
+            else
+                points(i);
+        }
+    }
+
+    void loop(const stp::TopoLoop& x)
+    {
+        varint(x.size());
+        for (auto& i : x) {
+            varint(i.edge);
+            u8(i.orient);
+        }
+    }
+
+    const string& buffer() const
+    {
+        return buffer_;
+    }
+
+private:
+    string buffer_;
+};
+
+class Reader {
+public:
+    explicit Reader(string_view data)
+        : data_(data)
+        , pos_(0)
+    {
+    }
+
+    string_view bytes(size_t size)
+    {
+        CHECK_IF(size > data_.size() - pos_, err::bad_snapshot,
+                 "unexpected end of snapshot");
+        auto result = data_.substr(pos_, size);
+        pos_ += size;
+        return result;
+    }
+
+    uint8_t u8()
+    {
+        return uint8_t(bytes(1)[0]);
+    }
+
+    uint32_t u32()
+    {
+        auto p = bytes(4);
+        uint32_t result = 0;
+        for (int i = 0; i < 4; ++i)
+            result |= uint32_t(uint8_t(p[i])) << (8 * i);
+        return result;
+    }
+
+    uint64_t u64()
+    {
+        auto p = bytes(8);
+        uint64_t result = 0;
+        for (int i = 0; i < 8; ++i)
+            result |= uint64_t(uint8_t(p[i])) << (8 * i);
+        return result;
+    }
+
+    double f64()
+    {
+        auto bits = u64();
+        double result;
+        memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+
+    uint64_t varint()
+    {
+        uint64_t result = 0;
+        for (int shift = 0;; shift += 7) {
+            CHECK_IF(shift > 63, err::bad_snapshot, "malformed varint");
+            auto byte = u8();
+            result |= uint64_t(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+                return result;
+        }
+    }
+
+    // Reads a count of items taking at least size bytes each.
+    uint64_t count(size_t size)
+    {
+        auto result = varint();
+        CHECK_IF(result > (data_.size() - pos_) / size, err::bad_snapshot,
+                 "unexpected end of snapshot");
+        return result;
+    }
+
+    // Reads an index into a list of size items.
+    size_t index(size_t size)
+    {
+        auto result = varint();
+        CHECK_IF(result >= size, err::bad_snapshot, "index out of range");
+        return size_t(result);
+    }
+
+    bool flag()
+    {
+        auto result = u8();
+        CHECK_IF(result > 1, err::bad_snapshot, "malformed flag");
+        return result != 0;
+    }
+
+    coords_t coords()
+    {
+        coords_t result;
+        for (auto& i : result)
+            i = f64();
+        return result;
+    }
+
+    StepAxisData axis()
+    {
+        auto center = coords();
+        auto z = coords();
+        auto ref = coords();
+        return {center, z, ref};
+    }
+
+    vector<size_t> sizes()
+    {
+        vector<size_t> result(count(1));
+        for (auto& i : result)
+            i = size_t(varint());
+        return result;
+    }
+
+    vector<double> numbers()
+    {
+        vector<double> result(count(8));
+        for (auto& i : result)
+            i = f64();
+        return result;
+    }
+
+    vector<coords_t> points()
+    {
+        vector<coords_t> result(count(24));
+        for (auto& i : result)
+            i = coords();
+        return result;
+    }
+
+    template <class T>
+    vector<vector<T>> rows()
+    {
+        vector<vector<T>> result(count(1));
+        for (auto& i : result) {
+            if constexpr (is_same_v<T, double>)
+                i = numbers();
+            else
+                i = points();
+        }
+        return result;
+    }
+
+    stp::TopoLoop loop(size_t edges)
+    {
+        stp::TopoLoop result(count(2));
+        for (auto& i : result) {
+            i.edge = index(edges);
+            i.orient = flag();
+        }
+        return result;
+    }
+
+    bool eof() const
+    {
+        return pos_ == data_.size();
+    }
+
+private:
+    string_view data_;
+    size_t pos_;
+};
+
+void write_curve(Writer& out, const StepCurveData& x)
+{
+    out.u8(uint8_t(x.type));
+    if (is_bspline(x.type)) {
+        out.varint(x.degree);
+        out.sizes(x.mults);
+        out.numbers(x.knots);
+        out.points(x.points);
+        out.numbers(x.weights);
+    } else {
+        out.axis(x.axis);
+        out.f64(x.a);
+        out.f64(x.b);
+    }
+}
+
+StepCurveData read_curve(Reader& in)
+{
+    auto type = in.u8();
+    CHECK_IF(type > uint8_t(StepCurve::RATIONAL_B_SPLINE_CURVE),
+             err::bad_snapshot, "unknown curve type");
+    StepCurveData result {StepCurve(type), {}, 0, 0, 0, {}, {}, {}, {}};
+    if (is_bspline(result.type)) {
+        result.degree = size_t(in.varint());
+        result.mults = in.sizes();
+        result.knots = in.numbers();
+        result.points = in.points();
+        result.weights = in.numbers();
+        // edges along a B-spline end where its control points do
+        CHECK_IF(result.points.empty(), err::bad_snapshot,
+                 "B-spline curve without control points");
+    } else {
+        result.axis = in.axis();
+        result.a = in.f64();
+        result.b = in.f64();
+    }
+    return result;
+}
+
+void write_surface(Writer& out, const StepSurfaceData& x)
+{
+    out.u8(uint8_t(x.type));
+    if (is_bspline(x.type)) {
+        out.varint(x.udegree);
+        out.varint(x.vdegree);
+        out.sizes(x.umults);
+        out.sizes(x.vmults);
+        out.numbers(x.uknots);
+        out.numbers(x.vknots);
+        out.rows(x.points);
+        out.rows(x.weights);
+    } else {
+        out.axis(x.axis);
+        out.f64(x.a);
+        out.f64(x.b);
+    }
+}
+
+StepSurfaceData read_surface(Reader& in)
+{
+    auto type = in.u8();
+    CHECK_IF(type > uint8_t(StepSurface::RATIONAL_B_SPLINE_SURFACE),
+             err::bad_snapshot, "unknown surface type");
+    StepSurfaceData result {
+        StepSurface(type), {}, 0, 0, 0, 0, {}, {}, {}, {}, {}, {}};
+    if (is_bspline(result.type)) {
+        result.udegree = size_t(in.varint());
+        result.vdegree = size_t(in.varint());
+        result.umults = in.sizes();
+        result.vmults = in.sizes();
+        result.uknots = in.numbers();
+        result.vknots = in.numbers();
+        result.points = in.rows<coords_t>();
+        result.weights = in.rows<double>();
+    } else {
+        result.axis = in.axis();
+        result.a = in.f64();
+        result.b = in.f64();
+    }
+    return result;
+}
+
+} // namespace
+
+StepSnapshot::StepSnapshot(const StepLoader& load,
+                           const stp::Options& options)
+    : vertices_()
+    , curves_()
+    , surfaces_()
+    , edges_()
+    , shells_()
+{
+    auto strict = options;
+    strict.diagnostics = nullptr;
+    StepParser parse(load, strict);
+
+    // entities are numbered in order of first use, as in a stp::Topology
+    IdTable<size_t> vertex_index, curve_index, surface_index, edge_index;
+    auto index = [](IdTable<size_t>& table, auto& list, size_t id,
+                    auto&& decode) {
+        auto [result, inserted] = table.emplace(id, list.size());
+        if (inserted)
+            list.emplace_back(decode());
+        return *result;
+    };
+    auto vertex = [&](size_t id) {
+        return index(vertex_index, vertices_, id,
+                     [&] { return parse.vertex_data(id); });
+    };
+    auto edge = [&](size_t id) {
+        return index(edge_index, edges_, id, [&] {
+            auto [start_id, end_id, curve_id] = parse.edge_refs(id);
+            auto begin = vertex(start_id);
+            auto end = vertex(end_id);
+            auto curve = index(curve_index, curves_, curve_id,
+                               [&] { return parse.curve_data(curve_id); });
+            return Edge {curve, begin, end};
+        });
+    };
+    auto renumber = [&](stp::TopoLoop& loop) {
+        for (auto& use : loop)
+            use.edge = edge(use.edge);
+    };
+
+    for (auto [shell_id, axis_id] : parse.shell_refs()) {
+        Shell shell {parse.axis_data(axis_id), {}};
+        for (auto face_id : parse.get_faces(shell_id)) {
+            auto refs = parse.face_refs(face_id);
+            renumber(refs.outer);
+            for (auto& loop : refs.inner)
+                renumber(loop);
+            auto surface
+                = index(surface_index, surfaces_, refs.surface,
+                        [&] { return parse.surface_data(refs.surface); });
+            shell.faces.push_back({surface, refs.same_sense,
+                                   move(refs.outer), move(refs.inner)});
+        }
+        shells_.emplace_back(move(shell));
+    }
+}
+
+StepSnapshot::StepSnapshot(string_view data)
+    : vertices_()
+    , curves_()
+    , surfaces_()
+    , edges_()
+    , shells_()
+{
+    Reader in(data);
+
+    CHECK_IF(in.bytes(sizeof(magic)) != string_view(magic, sizeof(magic)),
+             err::bad_snapshot, "not a snapshot");
+    auto ver = in.u32();
+    CHECK_IF(ver != version, err::bad_snapshot,
+             "unsupported snapshot version " + to_string(ver));
+
+    vertices_ = in.points();
+    curves_.resize(in.count(1));
+    for (auto& i : curves_)
+        i = read_curve(in);
+    surfaces_.resize(in.count(1));
+    for (auto& i : surfaces_)
+        i = read_surface(in);
+    edges_.resize(in.count(3));
+    for (auto& i : edges_) {
+        i.curve = in.index(curves_.size());
+        i.begin = in.index(vertices_.size());
+        i.end = in.index(vertices_.size());
+    }
+    shells_.resize(in.count(1));
+    for (auto& i : shells_) {
+        i.axis = in.axis();
+        i.faces.resize(in.count(4));
+        for (auto& face : i.faces) {
+            face.surface = in.index(surfaces_.size());
+            face.same_sense = in.flag();
+            face.outer = in.loop(edges_.size());
+            face.inner.resize(in.count(1));
+            for (auto& loop : face.inner)
+                loop = in.loop(edges_.size());
+        }
+    }
+    CHECK_IF(!in.eof(), err::bad_snapshot, "trailing data in snapshot");
+}
+
+void StepSnapshot::write(ostream& os) const
+{
+    Writer out;
+    out.bytes(magic, sizeof(magic));
+    out.u32(version);
+
+    out.points(vertices_);
+    out.varint(curves_.size());
+    for (auto& i : curves_)
+        write_curve(out, i);
+    out.varint(surfaces_.size());
+    for (auto& i : surfaces_)
+        write_surface(out, i);
+    out.varint(edges_.size());
+    for (auto& i : edges_) {
+        out.varint(i.curve);
+        out.varint(i.begin);
+        out.varint(i.end);
+    }
+    out.varint(shells_.size());
+    for (auto& i : shells_) {
+        out.axis(i.axis);
+        out.varint(i.faces.size());
+        for (auto& face : i.faces) {
+            out.varint(face.surface);
+            out.u8(face.same_sense);
+            out.loop(face.outer);
+            out.varint(face.inner.size());
+            for (auto& loop : face.inner)
+                out.loop(loop);
+        }
+    }
+
+    os.write(out.buffer().data(), streamsize(out.buffer().size()));
+    CHECK_IF(!os, err::snapshot_not_written, "failed to write snapshot");
+}
+
+stp::Topology StepSnapshot::take_topology(stp::ParseProgress* progress)
+{
+    stp::Topology result;
+    if (progress) {
+        size_t faces = 0;
+        for (auto& i : shells_)
+            faces += i.faces.size();
+        progress->shells_total = shells_.size();
+        progress->faces_total = faces;
+    }
+
+    result.vertices.reserve(vertices_.size());
+    for (auto& i : vertices_)
+        result.vertices.emplace_back(to_point(i));
+    vector<shared_ptr<gm::AbstractCurve>> curves;
+    curves.reserve(curves_.size());
+    for (auto& i : curves_)
+        curves.emplace_back(make_curve(move(i)));
+    vector<shared_ptr<gm::AbstractSurface>> surfaces;
+    surfaces.reserve(surfaces_.size());
+    for (auto& i : surfaces_)
+        surfaces.emplace_back(make_surface(move(i)));
+    result.edges.reserve(edges_.size());
+    for (auto& i : edges_)
+        result.edges.push_back({curves[i.curve], i.begin, i.end});
+
+    result.shells.reserve(shells_.size());
+    for (auto& i : shells_) {
+        CHECK_IF(progress && progress->cancelled(), err::parse_cancelled,
+                 "parse cancelled");
+        vector<stp::TopoFace> faces;
+        faces.reserve(i.faces.size());
+        for (auto& face : i.faces)
+            faces.push_back({surfaces[face.surface], face.same_sense,
+                             move(face.outer), move(face.inner)});
+        result.shells.push_back({make_axis(i.axis), move(faces)});
+        if (progress) {
+            progress->faces_built += i.faces.size();
+            ++progress->shells_built;
+        }
+    }
+
+    vertices_.clear();
+    curves_.clear();
+    surfaces_.clear();
+    edges_.clear();
+    shells_.clear();
+    return result;
+}
@@ -0,0 +1,75 @@
+#ifndef STEPPARSE_SRC_STEP_STEP_SNAPSHOT_HPP_
+#define STEPPARSE_SRC_STEP_STEP_SNAPSHOT_HPP_
+
+#include <stp/options.hpp>
+#include <stp/topology.hpp>
+#include <util/debug.hpp>
+
+#include "step_geometry.hpp"
+#include "step_loader.hpp"
+
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+EXCEPT(bad_snapshot, "")
+EXCEPT(snapshot_not_written, "")
+
+// Decoded entities the shells of a STEP file are built from: the numbers
+// of every point, curve and surface and which edges and faces use them.
+// Vertices, edges, curves and surfaces are stored once however many faces
+// share them. Reading a snapshot builds the same shells as parsing the
+// file it was taken from, straight from these numbers, without any text
+// to lex or records to read.
+// The binary form is little-endian and starts with a version number; a
+// snapshot of another version is rejected rather than converted.
+class StepSnapshot {
+public:
+    // Bump whenever the layout or the numbering of StepCurve or
+    // StepSurface changes.
+    static constexpr uint32_t version = 2;
+
+    // Edge along curves_[curve] between vertices_[begin] and
+    // vertices_[end].
+    struct Edge {
+        size_t curve;
+        size_t begin;
+        size_t end;
+    };
+    // Face on surfaces_[surface] whose loops refer to edges_.
+    struct Face {
+        size_t surface;
+        bool same_sense;
+        stp::TopoLoop outer;
+        std::vector<stp::TopoLoop> inner;
+    };
+    struct Shell {
+        StepAxisData axis;
+        std::vector<Face> faces;
+    };
+
+    // Decodes the shells of load. Unlike a parse, taking a snapshot is
+    // never lenient.
+    explicit StepSnapshot(const StepLoader& load,
+                          const stp::Options& options = stp::Options());
+    // Throws err::bad_snapshot if data is not a snapshot of this version.
+    explicit StepSnapshot(std::string_view data);
+
+    // Throws err::snapshot_not_written if os fails.
+    void write(std::ostream& os) const;
+
+    // Builds the shells with every curve and surface shared by all of its
+    // uses, as a parse does. Decoded entities are moved out, so this is
+    // called once. Progress is reported and cancellation checked per shell.
+    stp::Topology take_topology(stp::ParseProgress* progress = nullptr);
+
+private:
+    std::vector<coords_t> vertices_;
+    std::vector<StepCurveData> curves_;
+    std::vector<StepSurfaceData> surfaces_;
+    std::vector<Edge> edges_;
+    std::vector<Shell> shells_;
+};
+
+#endif // STEPPARSE_SRC_STEP_STEP_SNAPSHOT_HPP_
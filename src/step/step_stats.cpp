@@ -0,0 +1,112 @@
+#include "step_stats.hpp"
+
+#include <utility>
+
+using namespace std;
+
+#ifndef STP_NO_STATS
+namespace {
+
+thread_local StepStats::Scope* current_scope = nullptr;
+
+} // namespace
+#endif
+
+double stp::ParseStats::reads_per_record() const
+{
+    return records_read ? double(reads) / double(records_read) : 0.;
+}
+
+stp::ParseStats& stp::ParseStats::operator+=(const ParseStats& other)
+{
+    auto add = [](Cache& to, const Cache& from) {
+        to.hits += from.hits;
+        to.misses += from.misses;
+    };
+
+    bytes_scanned += other.bytes_scanned;
+    records_seen += other.records_seen;
+    for (auto& [keyword, count] : other.records_kept)
+        records_kept[keyword] += count;
+
+    load_time += other.load_time;
+    lex_time += other.lex_time;
+    curve_time += other.curve_time;
+    surface_time += other.surface_time;
+    face_time += other.face_time;
+
+    add(edge_cache, other.edge_cache);
+    add(curve_cache, other.curve_cache);
+    add(surface_cache, other.surface_cache);
+    add(entity_cache, other.entity_cache);
+
+    reads += other.reads;
+    records_read += other.records_read;
+    return *this;
+}
+
+#ifndef STP_NO_STATS
+StepStats::Scope::Scope(StepStats* stats, Stage stage)
+    : stats_(stats)
+    , stage_(stage)
+    , start_()
+    , nested_(0)
+    , parent_(nullptr)
+{
+    if (stats_) {
+        parent_ = exchange(current_scope, this);
+        start_ = clock_t::now();
+    }
+}
+
+StepStats::Scope::~Scope()
+{
+    if (stats_) {
+        auto elapsed = clock_t::now() - start_;
+        stats_->add(stage_, elapsed - nested_);
+        if (parent_)
+            parent_->nested_ += elapsed;
+        current_scope = parent_;
+    }
+}
+#endif
+
+StepStats::StepStats(stp::ParseStats& target)
+    : target_(target)
+    , counters_()
+    , times_()
+{
+}
+
+stp::ParseStats& StepStats::target()
+{
+    return target_;
+}
+
+void StepStats::flush()
+{
+    auto take = [](auto& x) { return x.exchange(0, memory_order_relaxed); };
+    auto time = [&](Stage stage) {
+        return chrono::duration_cast<stp::ParseStats::duration_t>(
+            clock_t::duration(take(times_[stage])));
+    };
+
+    target_.load_time += time(LOAD);
+    target_.lex_time += time(LEX);
+    target_.curve_time += time(CURVE);
+    target_.surface_time += time(SURFACE);
+    target_.face_time += time(FACE);
+
+    target_.edge_cache.hits += take(counters_[EDGE_HIT]);
+    target_.edge_cache.misses += take(counters_[EDGE_MISS]);
+    target_.curve_cache.hits += take(counters_[CURVE_HIT]);
+    target_.curve_cache.misses += take(counters_[CURVE_MISS]);
+    target_.surface_cache.hits += take(counters_[SURFACE_HIT]);
+    target_.surface_cache.misses += take(counters_[SURFACE_MISS]);
+    target_.entity_cache.hits += take(counters_[ENTITY_HIT]);
+    target_.entity_cache.misses += take(counters_[ENTITY_MISS]);
+
+    // every record is lexed once, the first time it is read
+    target_.reads += take(counters_[READS]);
+    target_.records_read += take(counters_[LEXED]);
+}
@@ -0,0 +1,92 @@
+#ifndef STEPPARSE_SRC_STEP_STEP_STATS_HPP_
+#define STEPPARSE_SRC_STEP_STEP_STATS_HPP_
+
+#include <stp/stats.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef STP_NO_STATS
+#define STP_STATS_ENABLED false
+#else
+#define STP_STATS_ENABLED true
+#endif
+
+// Accumulates stp::ParseStats from several threads with relaxed atomics
+// and adds them to the caller's object on flush().
+class StepStats {
+public:
+    using clock_t = std::chrono::steady_clock;
+
+    enum Stage { LOAD, LEX, CURVE, SURFACE, FACE, STAGE_COUNT };
+    enum Counter {
+        EDGE_HIT,
+        EDGE_MISS,
+        CURVE_HIT,
+        CURVE_MISS,
+        SURFACE_HIT,
+        SURFACE_MISS,
+        ENTITY_HIT,
+        ENTITY_MISS,
+        READS,
+        LEXED,
+        COUNTER_COUNT
+    };
+
+    // Times a stage on the current thread. The time of nested scopes is
+    // taken off the enclosing one, so stages do not count each other. A
+    // null stats makes it a no-op, and so does building without stats,
+    // where it is an empty type that compiles away entirely.
+#ifdef STP_NO_STATS
+    class Scope {
+    public:
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        Scope(StepStats*, Stage) noexcept
+        {
+        }
+    };
+#else
+    class Scope {
+    public:
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        Scope(StepStats* stats, Stage stage);
+        ~Scope();
+
+    private:
+        StepStats* stats_;
+        Stage stage_;
+        clock_t::time_point start_;
+        clock_t::duration nested_;
+        Scope* parent_;
+    };
+#endif
+
+    explicit StepStats(stp::ParseStats& target);
+
+    void add(Counter counter, size_t count = 1)
+    {
+        counters_[counter].fetch_add(count, std::memory_order_relaxed);
+    }
+
+    void add(Stage stage, clock_t::duration time)
+    {
+        times_[stage].fetch_add(time.count(), std::memory_order_relaxed);
+    }
+
+    stp::ParseStats& target();
+    void flush();
+
+private:
+    stp::ParseStats& target_;
+    std::array<std::atomic<uint64_t>, COUNTER_COUNT> counters_;
+    std::array<std::atomic<clock_t::rep>, STAGE_COUNT> times_;
+};
+
+#endif // STEPPARSE_SRC_STEP_STEP_STATS_HPP_
@@ -1,12 +1,37 @@
 #include "step_tokenizer.hpp"
 
-#include <sstream>
+#include <iterator>
+#include <vector>
 
 using namespace std;
 
-StepTokenizer::StepTokenizer(const string& str)
-    : Tokenizer(nullptr, ", \n\t\r", ".'")
-    , is_(str)
+namespace {
+
+// Tokens the buffer of a thread keeps room for between records. A larger
+// record, such as a big B-spline surface, frees what it grew the buffer
+// to, rather than pinning it for the life of the thread.
+constexpr size_t kept_tokens = size_t(1) << 12;
+
+} // namespace
+
+StepTokenizer::StepTokenizer(string_view str)
+    : Tokenizer(str, chars)
 {
-    Tokenizer::set_istream(is_);
-}
\ No newline at end of file
+}
+
+TokenList step_lex(string_view str, pmr::memory_resource* resource)
+{
+    // a monotonic resource would keep every buffer a growing list leaves
+    // behind, so tokens are gathered in one the thread reuses
+    thread_local vector<Token> buffer;
+
+    buffer.clear();
+    StepTokenizer tok(str);
+    for (tok.next(); !tok.eof(); tok.next())
+        buffer.emplace_back(*tok);
+    TokenList result(make_move_iterator(begin(buffer)),
+                     make_move_iterator(end(buffer)), resource);
+    if (buffer.capacity() > kept_tokens)
+        vector<Token>().swap(buffer);
+    return result;
+}
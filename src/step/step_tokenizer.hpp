@@ -3,21 +3,27 @@
 
 #include <tokenizer/tokenizer.hpp>
 
-#include <sstream>
+#include <memory_resource>
+#include <string_view>
 
 class StepTokenizer : public Tokenizer {
 public:
+    static constexpr CharTable chars {", \n\t\r", ".'"};
+
     StepTokenizer() = default;
-    // StepTokenizer(const StepTokenizer&) = default;
+    StepTokenizer(const StepTokenizer&) = default;
     StepTokenizer(StepTokenizer&&) = default;
-    // StepTokenizer& operator=(const StepTokenizer&) = default;
+    StepTokenizer& operator=(const StepTokenizer&) = default;
     StepTokenizer& operator=(StepTokenizer&&) = default;
     ~StepTokenizer() = default;
 
-    explicit StepTokenizer(const std::string& str);
-
-private:
-    std::istringstream is_;
+    explicit StepTokenizer(std::string_view str);
 };
 
+// Lexes a whole record, e.g. to read it more than once. The result is
+// allocated from resource once, at its final size.
+TokenList step_lex(std::string_view str,
+                   std::pmr::memory_resource* resource
+                   = std::pmr::get_default_resource());
+
 #endif // STEPPARSE_SRC_STEP_STEP_TOKENIZER_HPP_
@@ -0,0 +1,101 @@
+#include "step_trace.hpp"
+
+#include <fmt/format.h>
+
+#include <atomic>
+
+using namespace std;
+
+namespace {
+
+size_t thread_number()
+{
+    static atomic<size_t> next(1);
+    thread_local size_t result = next++;
+    return result;
+}
+
+void write_json(ostream& os, string_view str)
+{
+    os << '"';
+    for (auto c : str) {
+        if (c == '"' || c == '\\')
+            os << '\\';
+        os << c;
+    }
+    os << '"';
+}
+
+} // namespace
+
+TraceSpan::TraceSpan(stp::TraceSink* sink, string_view category,
+                     string_view name, size_t id,
+                     clock_t::duration threshold)
+    : sink_(sink)
+    , category_(category)
+    , name_(name)
+    , type_(StepEntity::UNKNOWN)
+    , id_(id)
+    , threshold_(threshold)
+    , start_()
+{
+    if (sink_)
+        start_ = clock_t::now();
+}
+
+TraceSpan::TraceSpan(stp::TraceSink* sink, string_view category,
+                     StepEntity type, size_t id,
+                     clock_t::duration threshold)
+    : TraceSpan(sink, category, string_view(), id, threshold)
+{
+    type_ = type;
+}
+
+TraceSpan::~TraceSpan()
+{
+    if (!sink_)
+        return;
+    auto duration = clock_t::now() - start_;
+    if (duration < threshold_)
+        return;
+    auto name = type_ != StepEntity::UNKNOWN ? entity_keyword(type_) : name_;
+    sink_->event({category_, name, id_, start_, duration, thread_number()});
+}
+
+namespace stp {
+
+ChromeTrace::ChromeTrace(ostream& os)
+    : mutex_()
+    , os_(os)
+    , epoch_(TraceEvent::clock_t::now())
+    , first_(true)
+{
+    os_ << "[";
+}
+
+ChromeTrace::~ChromeTrace()
+{
+    os_ << "\n]\n";
+    os_.flush();
+}
+
+void ChromeTrace::event(const TraceEvent& event)
+{
+    using us_t = chrono::duration<double, micro>;
+    auto ts = chrono::duration_cast<us_t>(event.start - epoch_).count();
+    auto dur = chrono::duration_cast<us_t>(event.duration).count();
+
+    lock_guard<mutex> lock(mutex_);
+    os_ << (first_ ? "\n" : ",\n") << "{\"name\":";
+    write_json(os_, event.name);
+    os_ << ",\"cat\":";
+    write_json(os_, event.category);
+    os_ << fmt::format(",\"ph\":\"X\",\"ts\":{:.3f},\"dur\":{:.3f}", ts, dur)
+        << ",\"pid\":1,\"tid\":" << event.thread;
+    if (event.id != 0)
+        os_ << ",\"args\":{\"id\":\"#" << event.id << "\"}";
+    os_ << "}";
+    first_ = false;
+}
+
+} // namespace stp
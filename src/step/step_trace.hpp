@@ -0,0 +1,40 @@
+#ifndef STEPPARSE_SRC_STEP_STEP_TRACE_HPP_
+#define STEPPARSE_SRC_STEP_STEP_TRACE_HPP_
+
+#include <stp/trace.hpp>
+
+#include "step_entities.hpp"
+
+#include <cstddef>
+#include <string_view>
+
+// Reports the lifetime of the object to sink as a trace event if it lasts
+// at least threshold. A null sink makes it a no-op that does not even read
+// the clock.
+class TraceSpan {
+public:
+    using clock_t = stp::TraceEvent::clock_t;
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    TraceSpan(stp::TraceSink* sink, std::string_view category,
+              std::string_view name, size_t id = 0,
+              clock_t::duration threshold = clock_t::duration::zero());
+    // Named after the keyword of type, looked up only if the span is kept.
+    TraceSpan(stp::TraceSink* sink, std::string_view category,
+              StepEntity type, size_t id,
+              clock_t::duration threshold = clock_t::duration::zero());
+    ~TraceSpan();
+
+private:
+    stp::TraceSink* sink_;
+    std::string_view category_;
+    std::string_view name_;
+    StepEntity type_;
+    size_t id_;
+    clock_t::duration threshold_;
+    clock_t::time_point start_;
+};
+
+#endif // STEPPARSE_SRC_STEP_STEP_TRACE_HPP_
@@ -0,0 +1,47 @@
+#include <stp/topology.hpp>
+
+#include "step_geometry.hpp"
+
+using namespace std;
+
+namespace stp {
+
+namespace {
+
+gm::FaceBound make_bound(const Topology& topo, const TopoLoop& loop)
+{
+    gm::FaceBound result;
+    result.reserve(loop.size());
+    for (auto& use : loop)
+        result.emplace_back(topo.edge(use.edge), use.orient);
+    return result;
+}
+
+} // namespace
+
+gm::Edge Topology::edge(size_t i) const
+{
+    auto& e = edges.at(i);
+    return make_edge(e.curve, vertices.at(e.begin), vertices.at(e.end));
+}
+
+vector<gm::Shell> Topology::geom() const
+{
+    vector<gm::Shell> result(shells.size());
+    for (size_t i = 0; i < shells.size(); ++i) {
+        vector<gm::Face> faces;
+        faces.reserve(shells[i].faces.size());
+        for (auto& f : shells[i].faces) {
+            vector<gm::FaceBound> inner;
+            for (auto& loop : f.inner)
+                inner.emplace_back(make_bound(*this, loop));
+            faces.emplace_back(f.surface, f.same_sense,
+                               make_bound(*this, f.outer), inner);
+        }
+        result[i].set_ax(shells[i].axis);
+        result[i].set_faces(move(faces));
+    }
+    return result;
+}
+
+} // namespace stp
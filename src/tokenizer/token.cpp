@@ -2,59 +2,60 @@
 
 using namespace std;
 
-Token::Token(const Token::Id& i)
+Token::Token(Token::Id i) noexcept
     : id_(i)
+    , number_(0)
+    , str_()
 {
-    if (i == Id::NUMBER) {
-        data_ = 0.;
-    } else {
-        data_ = string();
-    }
 }
 
-Token::Token(const string& str)
+Token::Token(string_view str) noexcept
     : id_(Id::STR)
+    , number_(0)
+    , str_(str)
 {
-    data_ = str;
 }
 
-Token::Token(double num)
+Token::Token(double num) noexcept
     : id_(Id::NUMBER)
+    , number_(num)
+    , str_()
 {
-    data_ = num;
 }
 
-bool Token::empty() const
+bool Token::empty() const noexcept
 {
     return id_ == Id::NIL;
 }
 
-Token& Token::clear()
+Token& Token::clear() noexcept
 {
-    id_ = Id::NIL;
-    data_ = string();
-    return *this;
+    return *this = Token();
 }
 
-Token::Id Token::get_id() const
+Token::Id Token::get_id() const noexcept
 {
     return id_;
 }
 
+char Token::front() const noexcept
+{
+    return str_.empty() ? '\0' : str_.front();
+}
+
+string_view Token::str() const noexcept
+{
+    return str_;
+}
+
 string Token::to_str() const
 {
-    string result;
-    if (holds_alternative<string>(data_))
-        result = get<string>(data_);
-    return result;
+    return string(str_);
 }
 
-double Token::to_number() const
+double Token::to_number() const noexcept
 {
-    double result = 0;
-    if (holds_alternative<double>(data_))
-        result = get<double>(data_);
-    return result;
+    return number_;
 }
 
 string Token::raw() const
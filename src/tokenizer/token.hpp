@@ -1,32 +1,47 @@
 #ifndef STEPPARSE_SRC_TOKENIZER_TOKEN_HPP_
 #define STEPPARSE_SRC_TOKENIZER_TOKEN_HPP_
 
+#include <memory_resource>
 #include <ostream>
 #include <string>
-#include <variant>
+#include <string_view>
+#include <type_traits>
+#include <vector>
 
+// A number or a view of the text of a token in the lexed input, which has
+// to outlive it. Copying and reading a token never allocates.
 class Token {
 public:
     enum class Id { NIL, STR, NUMBER };
-    // using data_t = ; // util::union_t<std::string, double>;
 
-    explicit Token(const Token::Id& i = Token::Id::NIL);
-    explicit Token(const std::string& str);
-    explicit Token(double num);
+    explicit Token(Token::Id i = Token::Id::NIL) noexcept;
+    explicit Token(std::string_view str) noexcept;
+    explicit Token(double num) noexcept;
 
-    bool empty() const;
-    Token& clear();
+    bool empty() const noexcept;
+    Token& clear() noexcept;
 
-    Token::Id get_id() const;
+    Token::Id get_id() const noexcept;
+    // First character of a string token and '\0' otherwise, enough to tell
+    // punctuation such as '(' or '#' apart.
+    char front() const noexcept;
+    // Text of a string token, empty otherwise.
+    std::string_view str() const noexcept;
     std::string to_str() const;
-    double to_number() const;
+    double to_number() const noexcept;
     std::string raw() const;
 
 private:
     Token::Id id_;
-    std::variant<std::string, double> data_;
+    double number_;
+    std::string_view str_;
 };
 
+static_assert(std::is_trivially_copyable_v<Token>);
+
+// Tokens of a lexed record, allocated from the memory of the parse.
+using TokenList = std::pmr::vector<Token>;
+
 std::ostream& operator<<(std::ostream& os, const Token& x);
 
 #endif //
@@ -0,0 +1,100 @@
+#include "token_cursor.hpp"
+
+using namespace std;
+
+const Token TokenCursor::nil_;
+
+TokenCursor::TokenCursor()
+    : first_(nullptr)
+    , size_(0)
+    , pos_(string::npos)
+    , resource_(pmr::get_default_resource())
+{
+}
+
+TokenCursor::TokenCursor(const Token* first, const Token* last)
+    : first_(first)
+    , size_(size_t(last - first))
+    , pos_(string::npos)
+    , resource_(pmr::get_default_resource())
+{
+}
+
+TokenCursor::TokenCursor(const TokenList& tokens)
+    : first_(tokens.data())
+    , size_(tokens.size())
+    , pos_(string::npos)
+    , resource_(tokens.get_allocator().resource())
+{
+}
+
+TokenCursor& TokenCursor::operator++()
+{
+    if (pos_ == string::npos || pos_ < size_)
+        ++pos_;
+    return *this;
+}
+
+const TokenCursor TokenCursor::operator++(int)
+{
+    auto tmp = *this;
+    ++(*this);
+    return tmp;
+}
+
+const Token& TokenCursor::operator*() const
+{
+    return pos_ < size_ ? first_[pos_] : nil_;
+}
+
+const Token* TokenCursor::operator->() const
+{
+    return &**this;
+}
+
+TokenCursor& TokenCursor::next()
+{
+    return ++(*this);
+}
+
+string TokenCursor::get()
+{
+    return (**this).raw();
+}
+
+bool TokenCursor::operator==(const TokenCursor& other) const
+{
+    return (eof() && other.eof())
+        || (first_ == other.first_ && pos_ == other.pos_);
+}
+
+bool TokenCursor::operator!=(const TokenCursor& other) const
+{
+    return !(*this == other);
+}
+
+bool TokenCursor::eof() const
+{
+    return pos_ == size_;
+}
+
+size_t TokenCursor::list_size() const
+{
+    size_t depth = 0, result = 0;
+    for (auto i = pos_ + 1; i < size_; ++i, ++result) {
+        auto c = first_[i].front();
+        if (c == '(') {
+            ++depth;
+        } else if (c == ')') {
+            if (depth == 0)
+                break;
+            --depth;
+        }
+    }
+    return result;
+}
+
+pmr::memory_resource* TokenCursor::resource() const
+{
+    return resource_;
+}
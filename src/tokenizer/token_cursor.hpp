@@ -0,0 +1,48 @@
+#ifndef STEPPARSE_SRC_TOKENIZER_TOKEN_CURSOR_HPP_
+#define STEPPARSE_SRC_TOKENIZER_TOKEN_CURSOR_HPP_
+
+#include "token.hpp"
+
+#include <memory_resource>
+#include <string>
+
+// Walks an already lexed token array with the same interface as Tokenizer:
+// the current token is empty until the first increment and after the last.
+struct TokenCursor {
+    TokenCursor(const TokenCursor& other) = default;
+    TokenCursor(TokenCursor&& other) = default;
+    TokenCursor& operator=(const TokenCursor& other) = default;
+    TokenCursor& operator=(TokenCursor&& other) = default;
+
+    TokenCursor();
+    TokenCursor(const Token* first, const Token* last);
+    explicit TokenCursor(const TokenList& tokens);
+
+    TokenCursor& operator++();
+    const TokenCursor operator++(int);
+    const Token& operator*() const;
+    const Token* operator->() const;
+
+    TokenCursor& next();
+    std::string get();
+
+    bool operator==(const TokenCursor& other) const;
+    bool operator!=(const TokenCursor& other) const;
+
+    bool eof() const;
+    // Tokens between the current '(' and the ')' closing it, those of
+    // nested lists included; up to the end if it is not closed.
+    size_t list_size() const;
+    // Memory the tokens are allocated from, for lists read from them.
+    std::pmr::memory_resource* resource() const;
+
+private:
+    static const Token nil_;
+
+    const Token* first_;
+    size_t size_;
+    size_t pos_;
+    std::pmr::memory_resource* resource_;
+};
+
+#endif // STEPPARSE_SRC_TOKENIZER_TOKEN_CURSOR_HPP_
@@ -1,50 +1,43 @@
 #include "tokenizer.hpp"
 
-#include <stdexcept>
+#include <charconv>
 
 using namespace std;
 
 Tokenizer::Tokenizer()
-    : is_(nullptr)
+    : pos_(nullptr)
+    , end_(nullptr)
+    , chars_(nullptr)
     , token_()
-    , delimeters_()
-    , literal_()
+    , eof_(false)
 {
 }
 
-Tokenizer::Tokenizer(istream* is, const string& delim, const string& lit)
-    : is_(is)
+Tokenizer::Tokenizer(string_view input, const CharTable& chars)
+    : pos_(input.data())
+    , end_(input.data() + input.size())
+    , chars_(&chars)
     , token_()
-    , delimeters_(delim)
-    , literal_(lit)
+    , eof_(false)
 {
 }
 
 Tokenizer& Tokenizer::operator++()
 {
-    char c;
-    while (!eof() && is().get(c) && is_delim(c))
-        ;
-    if (eof()) {
+    skip_delim();
+    if (pos_ == end_) {
+        eof_ = true;
         token_ = Token();
     } else {
-        is().putback(c);
-        if (isdigit(c) || c == '-')
+        auto c = *pos_;
+        if (chars_->is(c, CharTable::NUMBER))
             token_ = Token(get_number());
-        else if (isalpha(c) || c == '_')
+        else if (chars_->is(c, CharTable::WORD_START))
             token_ = Token(get_word());
-        else if (is_lit(c)) {
-            auto mark = c;
-            string literal = string(1, c);
-            is().get(c);
-            while (is().get(c) && c != mark)
-                literal += c;
-            literal += mark;
-            token_ = Token(literal);
-        } else {
-            is().get(c);
-            token_ = Token(string(1, c));
-        }
+        else if (chars_->is(c, CharTable::LITERAL))
+            token_ = Token(get_literal());
+        else
+            token_ = Token(string_view(pos_++, 1));
     }
     return *this;
 }
@@ -56,53 +49,53 @@ const Tokenizer Tokenizer::operator++(int)
     return tmp;
 }
 
-double Tokenizer::get_number()
+void Tokenizer::skip_delim()
 {
-    double result = 0;
-    is() >> result;
-    return result;
+    while (pos_ != end_) {
+        if (chars_->is(*pos_, CharTable::DELIM)) {
+            ++pos_;
+        } else if (*pos_ == '/' && end_ - pos_ > 1 && pos_[1] == '*') {
+            auto comment = string_view(pos_ + 2, size_t(end_ - pos_ - 2));
+            auto last = comment.find("*/");
+            pos_ = last == string_view::npos ? end_ : pos_ + last + 4;
+        } else {
+            break;
+        }
+    }
 }
 
-string Tokenizer::get_word()
+double Tokenizer::get_number()
 {
-    string result;
-    char c;
-    while (is().get(c) && !is_word(c))
-        ;
-    if (!eof())
-        for (result += c; is().get(c) && is_word(c);)
-            result += c;
-    is().putback(c);
+    double result = 0;
+    auto [last, ec] = from_chars(pos_, end_, result);
+    pos_ = ec == errc() ? last : pos_ + 1;
     return result;
 }
 
-bool Tokenizer::is_word(char c) const
+string_view Tokenizer::get_word()
 {
-    return isalnum(c) || c == '_';
+    auto first = pos_;
+    while (pos_ != end_ && chars_->is(*pos_, CharTable::WORD))
+        ++pos_;
+    return string_view(first, size_t(pos_ - first));
 }
 
-bool Tokenizer::is_delim(char c) const
+string_view Tokenizer::get_literal()
 {
-    return delimeters_.find(c) != string::npos;
-}
-
-bool Tokenizer::is_lit(char c) const
-{
-    return literal_.find(c) != string::npos;
-}
-
-istream& Tokenizer::is() const
-{
-    if (!is_)
-        throw runtime_error(
-            "Null pointer exception: tokenizer input stream is not set");
-    return *is_;
-}
-
-bool Tokenizer::eof() const
-{
-    auto result = !(is_ && is());
-    return result;
+    auto first = pos_;
+    auto mark = *pos_++;
+    for (;;) {
+        while (pos_ != end_ && *pos_ != mark)
+            ++pos_;
+        if (pos_ == end_)
+            break;
+        ++pos_;
+        // a doubled quote stands for one quote inside a string literal
+        if (mark != '\'' || pos_ == end_ || *pos_ != mark)
+            break;
+        ++pos_;
+    }
+    return string_view(first, size_t(pos_ - first));
 }
 
 const Token& Tokenizer::operator*() const
@@ -117,7 +110,7 @@ const Token* Tokenizer::operator->() const
 
 bool Tokenizer::operator==(const Tokenizer& other) const
 {
-    return (eof() && other.eof()) || (is_ == other.is_);
+    return (eof() && other.eof()) || (pos_ == other.pos_);
 }
 
 bool Tokenizer::operator!=(const Tokenizer& other) const
@@ -125,6 +118,11 @@ bool Tokenizer::operator!=(const Tokenizer& other) const
     return !(*this == other);
 }
 
+bool Tokenizer::eof() const
+{
+    return eof_;
+}
+
 Tokenizer& Tokenizer::next()
 {
     return ++(*this);
@@ -135,8 +133,10 @@ string Tokenizer::get()
     return token_.raw();
 }
 
-Tokenizer& Tokenizer::set_istream(istream& is)
+Tokenizer& Tokenizer::set_input(string_view input)
 {
-    is_ = &is;
+    pos_ = input.data();
+    end_ = input.data() + input.size();
+    eof_ = false;
     return *this;
-}
\ No newline at end of file
+}
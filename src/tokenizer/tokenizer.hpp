@@ -3,9 +3,46 @@
 
 #include "token.hpp"
 
-#include <memory>
-#include <sstream>
+#include <array>
+#include <cstdint>
 #include <string>
+#include <string_view>
+
+// Character classes of a tokenizer, one entry per byte value.
+class CharTable {
+public:
+    enum : uint8_t {
+        DELIM = 1 << 0,
+        LITERAL = 1 << 1,
+        NUMBER = 1 << 2,
+        WORD_START = 1 << 3,
+        WORD = 1 << 4
+    };
+
+    constexpr CharTable(std::string_view delim, std::string_view lit)
+        : table_ {}
+    {
+        for (unsigned c = 0; c < table_.size(); ++c) {
+            if ('0' <= c && c <= '9')
+                table_[c] |= NUMBER | WORD;
+            if (('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || c == '_')
+                table_[c] |= WORD_START | WORD;
+        }
+        table_[uint8_t('-')] |= NUMBER;
+        for (auto c : delim)
+            table_[uint8_t(c)] |= DELIM;
+        for (auto c : lit)
+            table_[uint8_t(c)] |= LITERAL;
+    }
+
+    constexpr bool is(char c, uint8_t cls) const
+    {
+        return (table_[uint8_t(c)] & cls) != 0;
+    }
+
+private:
+    std::array<uint8_t, 256> table_;
+};
 
 struct Tokenizer {
     Tokenizer(const Tokenizer& other) = default;
@@ -14,8 +51,7 @@ struct Tokenizer {
     Tokenizer& operator=(Tokenizer&& other) = default;
 
     Tokenizer();
-    Tokenizer(std::istream* is, const std::string& delim,
-              const std::string& lit);
+    Tokenizer(std::string_view input, const CharTable& chars);
 
     Tokenizer& operator++();
     const Tokenizer operator++(int);
@@ -24,7 +60,7 @@ struct Tokenizer {
 
     Tokenizer& next();
     std::string get();
-    Tokenizer& set_istream(std::istream& is);
+    Tokenizer& set_input(std::string_view input);
 
     bool operator==(const Tokenizer& other) const;
     bool operator!=(const Tokenizer& other) const;
@@ -33,17 +69,15 @@ struct Tokenizer {
 
 private:
     double get_number();
-    std::string get_word();
-
-    std::istream& is() const;
-    bool is_delim(char c) const;
-    bool is_lit(char c) const;
-    bool is_word(char c) const;
+    std::string_view get_word();
+    std::string_view get_literal();
+    void skip_delim();
 
-    std::istream* is_;
+    const char* pos_;
+    const char* end_;
+    const CharTable* chars_;
     Token token_;
-    std::string delimeters_;
-    std::string literal_;
+    bool eof_;
 };
 
 #endif //
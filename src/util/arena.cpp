@@ -0,0 +1,62 @@
+#include "arena.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+using namespace std;
+
+namespace {
+
+atomic<uint64_t> next_key {1};
+
+struct LocalArena {
+    uint64_t key = 0;
+    pmr::memory_resource* arena = nullptr;
+};
+
+thread_local LocalArena current;
+
+} // namespace
+
+ThreadArena::ThreadArena(pmr::memory_resource* upstream)
+    : upstream_(upstream)
+    , key_(next_key++)
+    , mutex_()
+    , arenas_()
+{
+}
+
+ThreadArena::~ThreadArena() = default;
+
+void* ThreadArena::do_allocate(size_t bytes, size_t alignment)
+{
+    return local().allocate(bytes, alignment);
+}
+
+void ThreadArena::do_deallocate(void*, size_t, size_t)
+{
+}
+
+bool ThreadArena::do_is_equal(const pmr::memory_resource& other) const
+    noexcept
+{
+    return this == &other;
+}
+
+pmr::memory_resource& ThreadArena::local()
+{
+    if (current.key == key_)
+        return *current.arena;
+
+    auto id = this_thread::get_id();
+    lock_guard<mutex> lock(mutex_);
+    auto it = find_if(begin(arenas_), end(arenas_),
+                      [&](auto& i) { return i.first == id; });
+    if (it == end(arenas_)) {
+        arenas_.emplace_back(
+            id, make_unique<arena_t>(initial_size, upstream_));
+        it = prev(end(arenas_));
+    }
+    current = {key_, it->second.get()};
+    return *current.arena;
+}
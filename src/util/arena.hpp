@@ -0,0 +1,46 @@
+#ifndef STEPPARSE_SRC_UTIL_ARENA_HPP_
+#define STEPPARSE_SRC_UTIL_ARENA_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Monotonic arena shared by the threads of a parse. Each thread allocates
+// from its own monotonic_buffer_resource, so threads only synchronize on
+// their first allocation. Deallocation does nothing, all memory is returned
+// to upstream at once when the arena is destroyed.
+class ThreadArena : public std::pmr::memory_resource {
+public:
+    using arena_t = std::pmr::monotonic_buffer_resource;
+
+    static constexpr size_t initial_size = size_t(1) << 16;
+
+    ThreadArena(const ThreadArena&) = delete;
+    ThreadArena& operator=(const ThreadArena&) = delete;
+
+    explicit ThreadArena(std::pmr::memory_resource* upstream
+                         = std::pmr::get_default_resource());
+    ~ThreadArena() override;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(
+        const std::pmr::memory_resource& other) const noexcept override;
+
+    std::pmr::memory_resource& local();
+
+    std::pmr::memory_resource* upstream_;
+    // tells arenas apart in the per-thread cache, even one created where a
+    // destroyed one used to be
+    uint64_t key_;
+    std::mutex mutex_;
+    std::vector<std::pair<std::thread::id, std::unique_ptr<arena_t>>> arenas_;
+};
+
+#endif // STEPPARSE_SRC_UTIL_ARENA_HPP_
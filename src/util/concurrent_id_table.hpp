@@ -0,0 +1,85 @@
+#ifndef STEPPARSE_SRC_UTIL_CONCURRENT_ID_TABLE_HPP_
+#define STEPPARSE_SRC_UTIL_CONCURRENT_ID_TABLE_HPP_
+
+#include "id_table.hpp"
+
+#include <array>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <utility>
+
+// IdTable split into shards by id, each behind its own reader-writer lock,
+// for caches filled by several parser threads. Values are returned by copy,
+// so T should be a cheap handle such as a shared_ptr.
+template <class T>
+class ConcurrentIdTable {
+public:
+    static constexpr size_t shard_count = 64;
+
+    std::optional<T> find(size_t id) const
+    {
+        auto& s = shard(id);
+        std::shared_lock<std::shared_mutex> lock(s.mutex);
+        auto result = s.table.find(id / shard_count);
+        return result ? std::optional<T>(*result) : std::nullopt;
+    }
+
+    // Inserts value unless id is already present and returns the stored
+    // value, so threads racing on one id all end up with the same object,
+    // and whether it was inserted by this call.
+    std::pair<T, bool> emplace(size_t id, T value)
+    {
+        auto& s = shard(id);
+        std::unique_lock<std::shared_mutex> lock(s.mutex);
+        auto [result, inserted]
+            = s.table.emplace(id / shard_count, std::move(value));
+        return {*result, inserted};
+    }
+
+    bool erase(size_t id)
+    {
+        auto& s = shard(id);
+        std::unique_lock<std::shared_mutex> lock(s.mutex);
+        return s.table.erase(id / shard_count);
+    }
+
+    void clear()
+    {
+        for (auto& s : shards_) {
+            std::unique_lock<std::shared_mutex> lock(s.mutex);
+            s.table.clear();
+        }
+    }
+
+    size_t size() const
+    {
+        size_t result = 0;
+        for (auto& s : shards_) {
+            std::shared_lock<std::shared_mutex> lock(s.mutex);
+            result += s.table.size();
+        }
+        return result;
+    }
+
+private:
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        IdTable<T> table;
+    };
+
+    const Shard& shard(size_t id) const
+    {
+        return shards_[id % shard_count];
+    }
+
+    Shard& shard(size_t id)
+    {
+        return shards_[id % shard_count];
+    }
+
+    std::array<Shard, shard_count> shards_;
+};
+
+#endif // STEPPARSE_SRC_UTIL_CONCURRENT_ID_TABLE_HPP_
@@ -0,0 +1,83 @@
+#include "hash.hpp"
+
+#include <cstring>
+
+using namespace std;
+
+namespace {
+
+constexpr uint64_t prime1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t prime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t prime3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t prime4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t prime5 = 0x27D4EB2F165667C5ULL;
+
+inline uint64_t rotl(uint64_t x, int r) noexcept
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t load64(const char* p) noexcept
+{
+    uint64_t result;
+    memcpy(&result, p, sizeof(result));
+    return result;
+}
+
+inline uint64_t load32(const char* p) noexcept
+{
+    uint32_t result;
+    memcpy(&result, p, sizeof(result));
+    return result;
+}
+
+inline uint64_t round(uint64_t acc, uint64_t input) noexcept
+{
+    return rotl(acc + input * prime2, 31) * prime1;
+}
+
+inline uint64_t merge(uint64_t acc, uint64_t lane) noexcept
+{
+    return (acc ^ round(0, lane)) * prime1 + prime4;
+}
+
+} // namespace
+
+uint64_t content_hash(string_view data, uint64_t seed) noexcept
+{
+    auto p = data.data();
+    auto end = p + data.size();
+    uint64_t result;
+
+    if (data.size() >= 32) {
+        uint64_t v1 = seed + prime1 + prime2, v2 = seed + prime2, v3 = seed,
+                 v4 = seed - prime1;
+        for (; end - p >= 32; p += 32) {
+            v1 = round(v1, load64(p));
+            v2 = round(v2, load64(p + 8));
+            v3 = round(v3, load64(p + 16));
+            v4 = round(v4, load64(p + 24));
+        }
+        result = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        result = merge(merge(merge(merge(result, v1), v2), v3), v4);
+    } else {
+        result = seed + prime5;
+    }
+
+    result += uint64_t(data.size());
+    for (; end - p >= 8; p += 8)
+        result = rotl(result ^ round(0, load64(p)), 27) * prime1 + prime4;
+    if (end - p >= 4) {
+        result = rotl(result ^ (load32(p) * prime1), 23) * prime2 + prime3;
+        p += 4;
+    }
+    for (; p < end; ++p)
+        result = rotl(result ^ (uint8_t(*p) * prime5), 11) * prime1;
+
+    result ^= result >> 33;
+    result *= prime2;
+    result ^= result >> 29;
+    result *= prime3;
+    result ^= result >> 32;
+    return result;
+}
@@ -0,0 +1,12 @@
+#ifndef STEPPARSE_SRC_UTIL_HASH_HPP_
+#define STEPPARSE_SRC_UTIL_HASH_HPP_
+
+#include <cstdint>
+#include <string_view>
+
+// Fast non-cryptographic 64-bit hash of a byte range, four independent
+// multiply-rotate lanes over 8-byte words in the manner of xxHash64. Only
+// meant to tell whether cached data still matches its source.
+uint64_t content_hash(std::string_view data, uint64_t seed = 0) noexcept;
+
+#endif // STEPPARSE_SRC_UTIL_HASH_HPP_
@@ -0,0 +1,144 @@
+#ifndef STEPPARSE_SRC_UTIL_ID_TABLE_HPP_
+#define STEPPARSE_SRC_UTIL_ID_TABLE_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// Map from STEP instance id to T. Ids of a file are nearly dense, so values
+// live in a vector indexed by id; ids that would make the vector too sparse
+// (e.g. a handful of records numbered in the billions) go to an ordered
+// fallback map. Every id below dense_.size() is stored densely, which keeps
+// lookups to a single bounds check in the common case.
+template <class T>
+class IdTable {
+public:
+    static constexpr size_t min_dense = size_t(1) << 12;
+    static constexpr size_t max_sparsity = 8;
+
+    IdTable()
+        : dense_()
+        , sparse_()
+        , size_(0)
+    {
+    }
+
+    const T* find(size_t id) const
+    {
+        if (id < dense_.size())
+            return dense_[id] ? &*dense_[id] : nullptr;
+        auto it = sparse_.find(id);
+        return it != std::cend(sparse_) ? &it->second : nullptr;
+    }
+
+    T* find(size_t id)
+    {
+        return const_cast<T*>(std::as_const(*this).find(id));
+    }
+
+    bool contains(size_t id) const
+    {
+        return find(id) != nullptr;
+    }
+
+    // Inserts value at id unless it is already present, like map::emplace.
+    template <class... Args>
+    std::pair<T*, bool> emplace(size_t id, Args&&... args)
+    {
+        if (auto val = find(id); val)
+            return {val, false};
+
+        ++size_;
+        if (id >= dense_.size() && fits_dense(id))
+            grow(id);
+        if (id < dense_.size()) {
+            dense_[id].emplace(std::forward<Args>(args)...);
+            return {&*dense_[id], true};
+        }
+        auto it = sparse_.emplace(id, T(std::forward<Args>(args)...)).first;
+        return {&it->second, true};
+    }
+
+    T& operator[](size_t id)
+    {
+        return *emplace(id).first;
+    }
+
+    bool erase(size_t id)
+    {
+        bool result = false;
+        if (id < dense_.size()) {
+            result = dense_[id].has_value();
+            dense_[id].reset();
+        } else {
+            result = sparse_.erase(id) != 0;
+        }
+        size_ -= size_t(result);
+        return result;
+    }
+
+    // Preallocates dense storage for ids up to max_id if that is within the
+    // sparsity limit for count expected values.
+    void reserve(size_t max_id, size_t count)
+    {
+        if (max_id >= dense_.size()
+            && max_id < std::max(min_dense, max_sparsity * count))
+            grow(max_id);
+    }
+
+    void clear()
+    {
+        dense_.clear();
+        sparse_.clear();
+        size_ = 0;
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    // Calls f(id, value) for every value in ascending id order.
+    template <class F>
+    void for_each(F&& f) const
+    {
+        for (size_t i = 0; i < dense_.size(); ++i)
+            if (dense_[i])
+                f(i, *dense_[i]);
+        for (auto& i : sparse_)
+            f(i.first, i.second);
+    }
+
+private:
+    bool fits_dense(size_t id) const
+    {
+        return id < std::max(min_dense, max_sparsity * size_);
+    }
+
+    void grow(size_t id)
+    {
+        auto new_size = std::max(id + 1, dense_.size() + dense_.size() / 2);
+        dense_.resize(new_size);
+
+        // keep the invariant that ids below dense_.size() are never sparse
+        auto last = sparse_.lower_bound(new_size);
+        for (auto it = std::begin(sparse_); it != last;) {
+            dense_[it->first].emplace(std::move(it->second));
+            it = sparse_.erase(it);
+        }
+    }
+
+    std::vector<std::optional<T>> dense_;
+    std::map<size_t, T> sparse_;
+    size_t size_;
+};
+
+#endif // STEPPARSE_SRC_UTIL_ID_TABLE_HPP_
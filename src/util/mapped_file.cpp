@@ -0,0 +1,168 @@
+#include "mapped_file.hpp"
+
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+MappedFile::MappedFile() noexcept
+    : path_()
+    , data_(nullptr)
+    , size_(0)
+{
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : path_(move(other.path_))
+    , data_(exchange(other.data_, nullptr))
+    , size_(exchange(other.size_, 0))
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other) {
+        unmap();
+        path_ = move(other.path_);
+        data_ = exchange(other.data_, nullptr);
+        size_ = exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile()
+{
+    unmap();
+}
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const string& path)
+    : MappedFile()
+{
+    path_ = path;
+    auto file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING,
+                            FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    CHECK_IF(file == INVALID_HANDLE_VALUE, err::file_not_mapped,
+             "unable to open file: " + path);
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        THROW(err::file_not_mapped, "unable to stat file: " + path);
+    }
+    if (size.QuadPart == 0) {
+        CloseHandle(file);
+        return;
+    }
+
+    auto mapping
+        = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    CHECK_IF(mapping == nullptr, err::file_not_mapped,
+             "unable to map file: " + path);
+
+    auto view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    CHECK_IF(view == nullptr, err::file_not_mapped,
+             "unable to map file: " + path);
+
+    data_ = static_cast<const char*>(view);
+    size_ = size_t(size.QuadPart);
+}
+
+void MappedFile::evict() const noexcept
+{
+    // unlocking pages that are not locked removes them from the working set
+    if (data_)
+        VirtualUnlock(const_cast<char*>(data_), size_);
+}
+
+void MappedFile::unmap() noexcept
+{
+    if (data_)
+        UnmapViewOfFile(data_);
+    data_ = nullptr;
+    size_ = 0;
+}
+
+#else
+
+MappedFile::MappedFile(const string& path)
+    : MappedFile()
+{
+    path_ = path;
+    auto fd = ::open(path.c_str(), O_RDONLY);
+    CHECK_IF(fd < 0, err::file_not_mapped, "unable to open file: " + path);
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        THROW(err::file_not_mapped, "unable to stat file: " + path);
+    }
+    if (st.st_size == 0) {
+        ::close(fd);
+        return;
+    }
+
+    auto size = size_t(st.st_size);
+    auto view = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    CHECK_IF(view == MAP_FAILED, err::file_not_mapped,
+             "unable to map file: " + path);
+    ::madvise(view, size, MADV_SEQUENTIAL);
+
+    data_ = static_cast<const char*>(view);
+    size_ = size;
+}
+
+void MappedFile::evict() const noexcept
+{
+    if (!data_)
+        return;
+    auto view = const_cast<char*>(data_);
+    ::madvise(view, size_, MADV_DONTNEED);
+    ::madvise(view, size_, MADV_NORMAL);
+}
+
+void MappedFile::unmap() noexcept
+{
+    if (data_)
+        ::munmap(const_cast<char*>(data_), size_);
+    data_ = nullptr;
+    size_ = 0;
+}
+
+#endif
+
+const char* MappedFile::data() const noexcept
+{
+    return data_;
+}
+
+size_t MappedFile::size() const noexcept
+{
+    return size_;
+}
+
+string_view MappedFile::view() const noexcept
+{
+    return string_view(data_, size_);
+}
+
+const string& MappedFile::path() const noexcept
+{
+    return path_;
+}
@@ -0,0 +1,43 @@
+#ifndef STEPPARSE_SRC_UTIL_MAPPED_FILE_HPP_
+#define STEPPARSE_SRC_UTIL_MAPPED_FILE_HPP_
+
+#include "debug.hpp"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+EXCEPT(file_not_mapped, "")
+
+// Read-only memory mapping of a whole file. Views obtained from view()
+// stay valid for the lifetime of the object.
+class MappedFile {
+public:
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile() noexcept;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    ~MappedFile();
+
+    explicit MappedFile(const std::string& path);
+
+    const char* data() const noexcept;
+    size_t size() const noexcept;
+    std::string_view view() const noexcept;
+    const std::string& path() const noexcept;
+
+    // Drops the pages read so far from memory. The mapping stays valid,
+    // pages are read from the file again when next accessed.
+    void evict() const noexcept;
+
+private:
+    void unmap() noexcept;
+
+    std::string path_;
+    const char* data_;
+    size_t size_;
+};
+
+#endif // STEPPARSE_SRC_UTIL_MAPPED_FILE_HPP_
@@ -0,0 +1,101 @@
+#include "thread_pool.hpp"
+
+using namespace std;
+
+namespace {
+
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local size_t current_index = 0;
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t threads)
+    : queues_()
+    , threads_()
+    , mutex_()
+    , cv_()
+    , pending_(0)
+    , next_(0)
+    , stop_(false)
+{
+    if (threads == 0)
+        threads = max<size_t>(thread::hardware_concurrency(), 1);
+
+    for (size_t i = 0; i < threads; ++i)
+        queues_.emplace_back(make_unique<Queue>());
+    for (size_t i = 0; i < threads; ++i)
+        threads_.emplace_back([this, i] { work(i); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& i : threads_)
+        i.join();
+}
+
+size_t ThreadPool::size() const
+{
+    return threads_.size();
+}
+
+void ThreadPool::submit(task_t task)
+{
+    auto index = current_pool == this ? current_index
+                                      : next_++ % queues_.size();
+    // counted before it can be popped, so that pop never takes pending_
+    // below zero; a worker woken in between finds nothing and retries
+    {
+        lock_guard<mutex> lock(mutex_);
+        ++pending_;
+    }
+    {
+        lock_guard<mutex> lock(queues_[index]->mutex);
+        queues_[index]->tasks.emplace_back(move(task));
+    }
+    cv_.notify_one();
+}
+
+void ThreadPool::work(size_t index)
+{
+    current_pool = this;
+    current_index = index;
+
+    task_t task;
+    for (;;) {
+        if (pop(index, task)) {
+            task();
+            task = nullptr;
+            continue;
+        }
+        unique_lock<mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return stop_ || pending_ != 0; });
+        if (stop_ && pending_ == 0)
+            return;
+    }
+}
+
+bool ThreadPool::pop(size_t index, task_t& task)
+{
+    auto count = queues_.size();
+    for (size_t i = 0; i < count; ++i) {
+        auto& queue = *queues_[(index + i) % count];
+        lock_guard<mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            if (i == 0) {
+                task = move(queue.tasks.back());
+                queue.tasks.pop_back();
+            } else {
+                task = move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            --pending_;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,107 @@
+#ifndef STEPPARSE_SRC_UTIL_THREAD_POOL_HPP_
+#define STEPPARSE_SRC_UTIL_THREAD_POOL_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing pool. Every worker owns a deque: it runs its own tasks
+// newest first and, when it runs dry, steals the oldest task of another
+// worker. Tasks submitted from a worker go to that worker's deque.
+class ThreadPool {
+public:
+    using task_t = std::function<void()>;
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // 0 threads means one per hardware thread
+    explicit ThreadPool(size_t threads = 0);
+    ~ThreadPool();
+
+    size_t size() const;
+    void submit(task_t task);
+
+    // Calls f(i) for every i in [0, n) on the pool and the calling thread,
+    // returns when all calls are done and rethrows the first exception.
+    // Indices are claimed in order, so early ones start first.
+    template <class F>
+    void parallel_for(size_t n, F&& f);
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<task_t> tasks;
+    };
+
+    void work(size_t index);
+    bool pop(size_t index, task_t& task);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::atomic<size_t> pending_;
+    std::atomic<size_t> next_;
+    bool stop_;
+};
+
+template <class F>
+void ThreadPool::parallel_for(size_t n, F&& f)
+{
+    struct State {
+        std::atomic<size_t> next {0};
+        std::atomic<bool> failed {false};
+        size_t done = 0;
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable cv;
+    };
+
+    if (n == 0)
+        return;
+
+    auto state = std::make_shared<State>();
+    auto run = [state, n, &f] {
+        size_t count = 0;
+        for (size_t i; (i = state->next++) < n; ++count) {
+            if (state->failed)
+                continue;
+            try {
+                f(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (!state->error)
+                    state->error = std::current_exception();
+                state->failed = true;
+            }
+        }
+        if (count != 0) {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if ((state->done += count) == n)
+                state->cv.notify_all();
+        }
+    };
+
+    // helpers that start after every index is claimed return immediately,
+    // the shared state keeps them from touching a finished call
+    auto helpers = std::min(n - 1, size());
+    for (size_t i = 0; i < helpers; ++i)
+        submit(run);
+    run();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->cv.wait(lock, [&] { return state->done == n; });
+    if (state->error)
+        std::rethrow_exception(state->error);
+}
+
+#endif // STEPPARSE_SRC_UTIL_THREAD_POOL_HPP_
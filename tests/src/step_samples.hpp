@@ -0,0 +1,121 @@
+#ifndef STEPPARSE_TESTS_SRC_STEP_SAMPLES_HPP_
+#define STEPPARSE_TESTS_SRC_STEP_SAMPLES_HPP_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// STEP files made of shells of discs: planar faces bounded by a circle, all
+// placed on the shared #4. Every face has its own records, the numbering
+// below tells their ids.
+class DiscSample {
+public:
+    static constexpr size_t records_per_face = 9;
+
+    DiscSample(size_t shells, size_t faces)
+        : shells_(shells)
+        , faces_(faces)
+    {
+    }
+
+    // ADVANCED_FACE j of shell i; the records of the face precede it, from
+    // its CARTESIAN_POINT at face(i, j) - 8 to its PLANE at face(i, j) - 1.
+    size_t face(size_t i, size_t j) const
+    {
+        return 10 + (i * faces_ + j + 1) * records_per_face;
+    }
+    // EDGE_CURVE of face(i, j)
+    size_t edge(size_t i, size_t j) const
+    {
+        return face(i, j) - 6;
+    }
+    // CLOSED_SHELL i, followed by its MANIFOLD_SOLID_BREP and its
+    // ADVANCED_BREP_SHAPE_REPRESENTATION.
+    size_t shell(size_t i) const
+    {
+        return face(shells_ - 1, faces_ - 1) + 1 + i * 3;
+    }
+
+    std::string text() const
+    {
+        std::string result = "ISO-10303-21;\n"
+                             "HEADER;\n"
+                             "FILE_DESCRIPTION((''),'2;1');\n"
+                             "FILE_NAME('discs','',(''),(''),'','','');\n"
+                             "FILE_SCHEMA(('AUTOMOTIVE_DESIGN'));\n"
+                             "ENDSEC;\n"
+                             "DATA;\n"
+                             "#1=CARTESIAN_POINT('',(0.,0.,0.));\n"
+                             "#2=DIRECTION('',(0.,0.,1.));\n"
+                             "#3=DIRECTION('',(1.,0.,0.));\n"
+                             "#4=AXIS2_PLACEMENT_3D('',#1,#2,#3);\n";
+        for (size_t i = 0; i < shells_; ++i)
+            for (size_t j = 0; j < faces_; ++j)
+                add_face(result, i, j);
+        for (size_t i = 0; i < shells_; ++i) {
+            auto id = shell(i);
+            std::string faces;
+            for (size_t j = 0; j < faces_; ++j)
+                faces += (j ? ",#" : "#") + std::to_string(face(i, j));
+            add(result, id, "CLOSED_SHELL('',(" + faces + "))");
+            add(result, id + 1, "MANIFOLD_SOLID_BREP('',#" + ref(id) + ")");
+            add(result, id + 2,
+                "ADVANCED_BREP_SHAPE_REPRESENTATION('',(#" + ref(id + 1)
+                    + ",#4),#1000000)");
+        }
+        return result + "ENDSEC;\nEND-ISO-10303-21;\n";
+    }
+
+private:
+    static std::string ref(size_t id)
+    {
+        return std::to_string(id);
+    }
+
+    static void add(std::string& text, size_t id, std::string_view record)
+    {
+        text += "#" + ref(id) + "=";
+        text += record;
+        text += ";\n";
+    }
+
+    void add_face(std::string& text, size_t i, size_t j) const
+    {
+        auto id = face(i, j) - 8;
+        auto radius = std::to_string(i * faces_ + j + 1) + ".";
+        add(text, id, "CARTESIAN_POINT('',(" + radius + ",0.,0.))");
+        add(text, id + 1, "VERTEX_POINT('',#" + ref(id) + ")");
+        add(text, id + 2, "CIRCLE('',#4," + radius + ")");
+        add(text, id + 3,
+            "EDGE_CURVE('',#" + ref(id + 1) + ",#" + ref(id + 1) + ",#"
+                + ref(id + 2) + ",.T.)");
+        add(text, id + 4, "ORIENTED_EDGE('',*,*,#" + ref(id + 3) + ",.T.)");
+        add(text, id + 5, "EDGE_LOOP('',(#" + ref(id + 4) + "))");
+        add(text, id + 6, "FACE_OUTER_BOUND('',#" + ref(id + 5) + ",.T.)");
+        add(text, id + 7, "PLANE('',#4)");
+        add(text, id + 8,
+            "ADVANCED_FACE('',(#" + ref(id + 6) + "),#" + ref(id + 7)
+                + ",.T.)");
+    }
+
+    size_t shells_;
+    size_t faces_;
+};
+
+// Byte offset of the keyword of record id in text.
+inline size_t keyword_offset(std::string_view text, size_t id)
+{
+    auto prefix = "\n#" + std::to_string(id) + "=";
+    return text.find(prefix) + prefix.size();
+}
+
+// Replaces record id from its keyword up to its ';' with record.
+inline void replace_record(std::string& text, size_t id,
+                           std::string_view record)
+{
+    auto first = keyword_offset(text, id);
+    auto last = text.find(";\n", first);
+    text.replace(first, last - first, record);
+}
+
+#endif // STEPPARSE_TESTS_SRC_STEP_SAMPLES_HPP_
@@ -0,0 +1,107 @@
+#include <step/step_loader.hpp>
+#include <step/step_parser.hpp>
+#include <stp/parse.hpp>
+#include <stp/probe.hpp>
+
+#include <gtest/gtest.h>
+
+#include "step_samples.hpp"
+
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+string with_header(string_view header, string_view data)
+{
+    string result = "ISO-10303-21;\nHEADER;\n";
+    result += header;
+    result += "ENDSEC;\nDATA;\n";
+    result += data;
+    return result + "ENDSEC;\nEND-ISO-10303-21;\n";
+}
+
+} // namespace
+
+TEST(Probe, UnquotesHeader)
+{
+    auto result = stp::probe_buffer(with_header(
+        "FILE_DESCRIPTION(('it''s',''''),'2;1');\n"
+        "FILE_NAME('a;b','2026-10-17T00:00:00',('A ''B''',$),($),$,"
+        "'sys','');\n"
+        "FILE_SCHEMA(('AP203','AP214'));\n",
+        ""));
+    EXPECT_EQ(result.description, (vector<string> {"it's", "'"}));
+    EXPECT_EQ(result.implementation_level, "2;1");
+    EXPECT_EQ(result.name, "a;b");
+    EXPECT_EQ(result.time_stamp, "2026-10-17T00:00:00");
+    EXPECT_EQ(result.author, (vector<string> {"A 'B'", ""}));
+    EXPECT_EQ(result.organization, (vector<string> {""}));
+    EXPECT_EQ(result.preprocessor_version, "");
+    EXPECT_EQ(result.originating_system, "sys");
+    EXPECT_EQ(result.authorization, "");
+    EXPECT_EQ(result.schemas, (vector<string> {"AP203", "AP214"}));
+}
+
+// the fields of a malformed record stay empty, the others are still read
+TEST(Probe, SkipsMalformedHeaderRecord)
+{
+    auto result = stp::probe_buffer(with_header(
+        "FILE_DESCRIPTION(('part'),);\n"
+        "FILE_NAME('part');\n"
+        "FILE_SCHEMA(('AP203'));\n",
+        "#1=CARTESIAN_POINT('',(0.,0.,0.));\n"));
+    EXPECT_TRUE(result.description.empty());
+    EXPECT_EQ(result.implementation_level, "");
+    EXPECT_EQ(result.name, "");
+    EXPECT_TRUE(result.author.empty());
+    EXPECT_EQ(result.schemas, (vector<string> {"AP203"}));
+    EXPECT_EQ(result.records, 1u);
+}
+
+TEST(Probe, CountsRecordsByKeyword)
+{
+    auto result = stp::probe_buffer(with_header(
+        "",
+        "#1=CARTESIAN_POINT('',(0.,0.,0.));\n"
+        "#2=CARTESIAN_POINT('',(1.,0.,0.));\n"
+        "#3=(GEOMETRIC_REPRESENTATION_CONTEXT(3)"
+        "GLOBAL_UNIT_ASSIGNED_CONTEXT((#4)));\n"
+        "#4=(LENGTH_UNIT()NAMED_UNIT(*)SI_UNIT(.MILLI.,.METRE.));\n"
+        "#5=PRODUCT('part','part','',(#6));\n"
+        "#6=PRODUCT_CONTEXT('',#7,'mechanical');\n"
+        "#7=PRODUCT('other','other','',(#6));\n"));
+    EXPECT_EQ(result.records, 7u);
+    EXPECT_EQ(result.entities,
+              (map<string, size_t> {{"CARTESIAN_POINT", 2},
+                                    {"COMPLEX", 2},
+                                    {"PRODUCT", 2},
+                                    {"PRODUCT_CONTEXT", 1}}));
+    EXPECT_EQ(result.roots, 0u);
+    EXPECT_EQ(result.solids, 0u);
+    EXPECT_EQ(result.faces, 0u);
+}
+
+TEST(Probe, CountsWhatParseBuilds)
+{
+    auto input = DiscSample(3, 4).text();
+    auto result = stp::probe_buffer(input);
+
+    StepLoader load(input);
+    StepParser parser(load);
+    auto shells = parser.shell_refs();
+    size_t faces = 0;
+    for (auto [shell, axis] : shells)
+        faces += parser.get_faces(shell).size();
+
+    EXPECT_EQ(result.roots, 3u);
+    EXPECT_EQ(result.solids, shells.size());
+    EXPECT_EQ(result.faces, faces);
+    EXPECT_EQ(stp::parse_buffer(input).size(), result.solids);
+    EXPECT_EQ(result.entities.at("ADVANCED_FACE"), faces);
+    EXPECT_EQ(result.records, 4 + 3 * 4 * DiscSample::records_per_face + 9);
+}
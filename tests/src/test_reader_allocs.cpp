@@ -0,0 +1,98 @@
+#include <step/step_loader.hpp>
+#include <step/step_parser.hpp>
+#include <step/step_reader.hpp>
+#include <step/step_tokenizer.hpp>
+#include <tokenizer/token_cursor.hpp>
+
+#include <gtest/gtest.h>
+
+#include "alloc_counter.hpp"
+
+#include <string_view>
+
+using namespace std;
+
+namespace {
+
+// Heap allocations f makes on this thread, the tests run on one.
+template <class F>
+size_t allocations(F&& f)
+{
+    auto before = allocation_count();
+    f();
+    return allocation_count() - before;
+}
+
+template <class... Args>
+size_t read_allocations(string_view text)
+{
+    auto tokens = step_lex(text);
+    return allocations([&] { step_read<Args...>(TokenCursor(tokens)); });
+}
+
+constexpr string_view bspline
+    = "ISO-10303-21;\n"
+      "HEADER;\n"
+      "FILE_DESCRIPTION((''),'2;1');\n"
+      "ENDSEC;\n"
+      "DATA;\n"
+      "#1=CARTESIAN_POINT('',(0.,0.,0.));\n"
+      "#2=CARTESIAN_POINT('',(1.,0.,0.));\n"
+      "#3=CARTESIAN_POINT('',(2.,1.,0.));\n"
+      "#4=CARTESIAN_POINT('',(3.,1.,0.));\n"
+      "#5=B_SPLINE_CURVE_WITH_KNOTS('',3,(#1,#2,#3,#4),.UNSPECIFIED.,.F.,"
+      ".F.,(4,4),(0.,1.),.UNSPECIFIED.);\n"
+      "ENDSEC;\n"
+      "END-ISO-10303-21;\n";
+
+} // namespace
+
+TEST(ReaderAllocs, ScalarsAllocateNothing)
+{
+    EXPECT_EQ(read_allocations<str_>("'label'"), 0u);
+    EXPECT_EQ(read_allocations<ref_>("#12345"), 0u);
+    EXPECT_EQ(read_allocations<int_>("3"), 0u);
+    EXPECT_EQ(read_allocations<bool_>(".T."), 0u);
+    EXPECT_EQ(read_allocations<float_>("0.125"), 0u);
+    EXPECT_EQ(read_allocations<vec_>("(0.5,-1.25,2.)"), 0u);
+    EXPECT_EQ((read_allocations<br_<i_<str_>, ref_, float_>>("('',#42,2.5)")),
+              0u);
+    EXPECT_EQ((read_allocations<i_<str_, bool_>>("'ignored' .F.")), 0u);
+}
+
+// lists are sized from their tokens before they are read
+TEST(ReaderAllocs, ListsAllocateOnce)
+{
+    EXPECT_EQ(read_allocations<list_<float_>>("(0.,1.,2.,3.,4.,5.,6.,7.)"),
+              1u);
+    EXPECT_EQ(read_allocations<list_<int_>>("(4,1,1,1,1,4)"), 1u);
+    EXPECT_EQ(read_allocations<rlist_>("(#1,#2,#3,#4,#5,#6,#7,#8)"), 1u);
+    EXPECT_EQ(read_allocations<list_<float_>>("()"), 0u);
+}
+
+// one allocation for the rows and one for each row
+TEST(ReaderAllocs, MatricesAllocateOncePerRow)
+{
+    EXPECT_EQ(read_allocations<mat_<ref_>>(
+                  "((#1,#2,#3,#4),(#5,#6,#7,#8),(#9,#10,#11,#12),"
+                  "(#13,#14,#15,#16))"),
+              5u);
+    EXPECT_EQ(read_allocations<mat_<float_>>(
+                  "((1.,0.5,1.),(0.5,1.,0.5),(1.,0.5,1.))"),
+              4u);
+}
+
+TEST(ReaderAllocs, BSplineCurve)
+{
+    StepLoader load(bspline);
+    StepParser parse(load);
+    // lexes the records and caches the points
+    parse.curve_data(5);
+
+    // the multiplicities, knots and control points, the control point ids
+    // come from the arena of the parse
+    EXPECT_EQ(allocations([&] { parse.curve_data(5); }), 3u);
+    // and the points of the curve, the curve and its cache entry
+    EXPECT_EQ(allocations([&] { parse.get_curve(5); }), 6u);
+    EXPECT_EQ(allocations([&] { parse.get_curve(5); }), 0u);
+}
@@ -0,0 +1,155 @@
+#include <step/step_index.hpp>
+#include <step/step_loader.hpp>
+#include <step/step_stats.hpp>
+#include <util/mapped_file.hpp>
+
+#include <gtest/gtest.h>
+
+#include "step_samples.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+void write_file(const string& path, string_view text)
+{
+    ofstream os(path, ios::binary | ios::trunc);
+    os.write(text.data(), streamsize(text.size()));
+}
+
+string read_file(const string& path)
+{
+    ifstream is(path, ios::binary);
+    return string(istreambuf_iterator<char>(is), istreambuf_iterator<char>());
+}
+
+string temp_path()
+{
+    auto test = testing::UnitTest::GetInstance()->current_test_info();
+    auto name = string("stp_") + test->name() + ".stp";
+    return (filesystem::temp_directory_path() / name).string();
+}
+
+// A STEP file in the temporary directory named after the test, removed
+// with its sidecar.
+class IndexedFile : public testing::Test {
+protected:
+    IndexedFile()
+        : path_(temp_path())
+        , index_(StepIndex::path_for(path_))
+    {
+    }
+    ~IndexedFile() override
+    {
+        filesystem::remove(path_);
+        filesystem::remove(index_);
+    }
+
+    // Loads the file through its sidecar and expects the records a full
+    // scan finds. Returns the bytes the loader scanned, if stats are
+    // enabled.
+    size_t load_and_check()
+    {
+        stp::Options options;
+        stp::ParseStats stats;
+        options.index_cache = true;
+        options.stats = &stats;
+        StepLoader cached(MappedFile(path_), options);
+
+        auto text = read_file(path_);
+        StepLoader scanned(text);
+        size_t count = 0;
+        scanned.data().for_each([&](size_t id, const StepRecord& record) {
+            auto found = cached.data().find(id);
+            EXPECT_NE(found, nullptr) << "#" << id;
+            if (found) {
+                EXPECT_EQ(found->text, record.text) << "#" << id;
+                EXPECT_EQ(found->type, record.type) << "#" << id;
+            }
+            ++count;
+        });
+        EXPECT_EQ(cached.data().size(), count);
+        EXPECT_EQ(string(cached.readline()), string(scanned.readline()));
+        return stats.bytes_scanned;
+    }
+
+    // Whether the sidecar holds the index of the file as it is now.
+    bool index_current()
+    {
+        auto text = read_file(path_);
+        StepLoader::data_t data;
+        size_t stop = 0;
+        return StepIndex::read(index_, text, data, stop);
+    }
+
+    // Expects the sidecar to be rejected and written again.
+    void expect_rebuilt()
+    {
+        EXPECT_FALSE(index_current());
+        auto scanned = load_and_check();
+        if (STP_STATS_ENABLED)
+            EXPECT_GT(scanned, 0u);
+        EXPECT_TRUE(index_current());
+    }
+
+    string path_;
+    string index_;
+};
+
+} // namespace
+
+TEST_F(IndexedFile, WritesAndReusesSidecar)
+{
+    write_file(path_, DiscSample(2, 3).text());
+    EXPECT_FALSE(filesystem::exists(index_));
+    load_and_check();
+    EXPECT_TRUE(index_current());
+
+    // served from the sidecar, so nothing is scanned
+    EXPECT_EQ(load_and_check(), 0u);
+}
+
+// same size, but the records before #4 moved by a byte
+TEST_F(IndexedFile, RebuildsStaleSidecar)
+{
+    auto text = DiscSample(2, 3).text();
+    write_file(path_, text);
+    load_and_check();
+
+    text.erase(text.find("'discs'") + 5, 1);
+    text.insert(text.find("#4="), " ");
+    write_file(path_, text);
+    ASSERT_EQ(filesystem::file_size(path_), text.size());
+    expect_rebuilt();
+}
+
+TEST_F(IndexedFile, RebuildsTruncatedSidecar)
+{
+    write_file(path_, DiscSample(2, 3).text());
+    load_and_check();
+
+    auto index = read_file(index_);
+    write_file(index_, string_view(index).substr(0, index.size() - 1));
+    expect_rebuilt();
+
+    write_file(index_, string_view(index).substr(0, 20));
+    expect_rebuilt();
+}
+
+TEST_F(IndexedFile, RebuildsSidecarOfOtherVersion)
+{
+    write_file(path_, DiscSample(2, 3).text());
+    load_and_check();
+
+    auto index = read_file(index_);
+    auto version = StepIndex::version + 1;
+    index.replace(8, sizeof(version), reinterpret_cast<char*>(&version),
+                  sizeof(version));
+    write_file(index_, index);
+    expect_rebuilt();
+}
@@ -0,0 +1,97 @@
+#include <step/step_loader.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+namespace {
+
+constexpr string_view header = "ISO-10303-21;\n"
+                               "HEADER;\n"
+                               "FILE_DESCRIPTION((''),'2;1');\n"
+                               "ENDSEC;\n"
+                               "DATA;\n";
+constexpr string_view footer = "ENDSEC;\nEND-ISO-10303-21;\n";
+
+// Points #first to #last labelled label.
+string points(size_t first, size_t last, string_view label = "")
+{
+    string result;
+    for (auto i = first; i <= last; ++i) {
+        result += "#" + to_string(i) + "=CARTESIAN_POINT('";
+        result += label;
+        result += "',(" + to_string(i) + ".,0.,0.));\n";
+    }
+    return result;
+}
+
+// Loads input on one thread and on four and expects the same records.
+void expect_same_records(string_view input, size_t last_id)
+{
+    ASSERT_GT(input.size(), 2 * StepLoader::min_chunk_size);
+
+    stp::Options one, four;
+    one.load_threads = 1;
+    four.load_threads = 4;
+    StepLoader serial(input, one);
+    StepLoader parallel(input, four);
+
+    for (size_t id = 0; id <= last_id + 1; ++id) {
+        auto a = serial.data().find(id), b = parallel.data().find(id);
+        ASSERT_EQ(a != nullptr, b != nullptr) << "#" << id;
+        if (a) {
+            EXPECT_EQ(a->text, b->text) << "#" << id;
+            EXPECT_EQ(a->type, b->type) << "#" << id;
+        }
+    }
+    EXPECT_EQ(string(serial.readline()), string(parallel.readline()));
+}
+
+} // namespace
+
+TEST(StepLoader, ChunksMatchSerialLoad)
+{
+    auto count = 3 * StepLoader::min_chunk_size / 40;
+    expect_same_records(string(header) + points(1, count) + string(footer),
+                        count);
+}
+
+// every chunk boundary falls inside a label
+TEST(StepLoader, ChunkBoundaryInsideString)
+{
+    auto count = 3 * StepLoader::min_chunk_size / 60;
+    auto input = string(header) + points(1, count, ";;;;;;;;;;;;;;;;;;;;")
+        + string(footer);
+    expect_same_records(input, count);
+
+    StepLoader load(input);
+    ASSERT_NE(load.data().find(count), nullptr);
+    EXPECT_EQ(load.data().find(count)->text,
+              "CARTESIAN_POINT(';;;;;;;;;;;;;;;;;;;;',(" + to_string(count)
+                  + ".,0.,0.))");
+}
+
+TEST(StepLoader, ChunkBoundaryInsideComment)
+{
+    auto count = 3 * StepLoader::min_chunk_size / 60;
+    auto input = string(header) + points(1, count / 2);
+    for (auto i = count / 2 + 1; i <= count; ++i)
+        input += "/* ; ; ; ; ; ; */#" + to_string(i)
+            + "=CARTESIAN_POINT('',(0.,0.,0.));\n";
+    expect_same_records(input + string(footer), count);
+}
+
+// a record longer than a chunk, so the chunk after the one it starts in
+// has no record of its own
+TEST(StepLoader, RecordLongerThanChunk)
+{
+    auto count = StepLoader::min_chunk_size / 40;
+    auto input = string(header) + points(1, count);
+    input += points(count + 1, count + 1,
+                    string(2 * StepLoader::min_chunk_size, ';'));
+    input += points(count + 2, 2 * count) + string(footer);
+    expect_same_records(input, 2 * count);
+}
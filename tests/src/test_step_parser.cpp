@@ -0,0 +1,190 @@
+#include <step/step_loader.hpp>
+#include <step/step_parser.hpp>
+#include <util/thread_pool.hpp>
+
+#include <gtest/gtest.h>
+
+#include "step_samples.hpp"
+
+#include <exception>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// Threads a parse runs on: count as parse_threads, or pool if it is not
+// null.
+struct Threads {
+    size_t count;
+    ThreadPool* pool;
+};
+
+struct Parsed {
+    size_t shells;
+    size_t faces_built;
+    stp::Diagnostics diagnostics;
+};
+
+Parsed parse(const string& input, Threads threads, bool lenient)
+{
+    StepLoader load(input);
+    stp::Options options;
+    stp::ParseProgress progress;
+    Parsed result {0, 0, {}};
+    options.parse_threads = threads.count;
+    options.progress = &progress;
+    if (lenient)
+        options.diagnostics = &result.diagnostics;
+    result.shells
+        = StepParser(load, options, threads.pool).parse().geom().size();
+    result.faces_built = progress.faces_built;
+    return result;
+}
+
+// ADVANCED_FACE ids of the faces of every shell, in the order the parse
+// built them, told apart by their surfaces.
+vector<vector<size_t>> face_order(const string& input, Threads threads)
+{
+    StepLoader load(input);
+    stp::Options options;
+    stp::Diagnostics diagnostics;
+    options.parse_threads = threads.count;
+    options.diagnostics = &diagnostics;
+    StepParser parser(load, options, threads.pool);
+    auto topo = parser.topology();
+
+    map<const gm::AbstractSurface*, size_t> faces;
+    for (auto [shell, axis] : parser.shell_refs()) {
+        for (auto id : parser.get_faces(shell)) {
+            try {
+                auto surface = parser.face_refs(id).surface;
+                faces[parser.get_surface(surface).get()] = id;
+            } catch (const exception&) {
+            }
+        }
+    }
+    vector<vector<size_t>> result;
+    for (auto& shell : topo.shells) {
+        auto& ids = result.emplace_back();
+        for (auto& face : shell.faces)
+            ids.push_back(faces.at(face.surface.get()));
+    }
+    return result;
+}
+
+vector<tuple<size_t, string, size_t, string>>
+fields(const stp::Diagnostics& diagnostics)
+{
+    vector<tuple<size_t, string, size_t, string>> result;
+    for (auto& i : diagnostics)
+        result.emplace_back(i.id, i.entity, i.offset, i.reason);
+    return result;
+}
+
+// A sample of 6 shells of 5 faces with faces 1 of shell 2 and 3 of shell
+// 4 broken.
+string broken(const DiscSample& sample)
+{
+    auto result = sample.text();
+    replace_record(result, sample.face(2, 1), "ADVANCED_FACE('',(),.T.)");
+    replace_record(result, sample.edge(4, 3),
+                   "EDGE_CURVE('',#1000001,#1000001,#1000002,.T.)");
+    return result;
+}
+
+} // namespace
+
+TEST(StepParser, ThreadsKeepShellAndFaceOrder)
+{
+    DiscSample sample(6, 5);
+    auto input = sample.text();
+    ThreadPool pool(3);
+
+    vector<vector<size_t>> expected;
+    for (size_t i = 0; i < 6; ++i) {
+        auto& ids = expected.emplace_back();
+        for (size_t j = 0; j < 5; ++j)
+            ids.push_back(sample.face(i, j));
+    }
+    for (auto threads :
+         {Threads {1, nullptr}, Threads {4, nullptr}, Threads {1, &pool}}) {
+        EXPECT_EQ(face_order(input, threads), expected);
+        auto parsed = parse(input, threads, false);
+        EXPECT_EQ(parsed.shells, 6u);
+        EXPECT_EQ(parsed.faces_built, 30u);
+    }
+}
+
+TEST(StepParser, ThreadsKeepLenientOrder)
+{
+    DiscSample sample(6, 5);
+    auto input = broken(sample);
+    ThreadPool pool(3);
+
+    auto serial = parse(input, {1, nullptr}, true);
+    EXPECT_EQ(serial.shells, 6u);
+    EXPECT_EQ(serial.faces_built, 30u);
+    ASSERT_EQ(serial.diagnostics.size(), 2u);
+
+    auto order = face_order(input, {1, nullptr});
+    for (auto threads : {Threads {4, nullptr}, Threads {1, &pool}}) {
+        auto parsed = parse(input, threads, true);
+        EXPECT_EQ(parsed.shells, serial.shells);
+        EXPECT_EQ(parsed.faces_built, serial.faces_built);
+        EXPECT_EQ(fields(parsed.diagnostics), fields(serial.diagnostics));
+        EXPECT_EQ(face_order(input, threads), order);
+    }
+}
+
+// a lenient parse skips the faces that cannot be built and keeps the rest
+// of their shells
+TEST(StepParser, LenientSkipsBrokenFaces)
+{
+    DiscSample sample(2, 4);
+    auto input = sample.text();
+    auto malformed = sample.face(0, 1), dangling = sample.face(1, 2);
+    replace_record(input, malformed, "ADVANCED_FACE('',(),.T.)");
+    replace_record(input, dangling,
+                   "ADVANCED_FACE('',(#1000001),#"
+                       + to_string(dangling - 1) + ",.T.)");
+    ThreadPool pool(3);
+
+    vector<vector<size_t>> kept {
+        {sample.face(0, 0), sample.face(0, 2), sample.face(0, 3)},
+        {sample.face(1, 0), sample.face(1, 1), sample.face(1, 3)}};
+    for (auto threads :
+         {Threads {1, nullptr}, Threads {4, nullptr}, Threads {1, &pool}}) {
+        EXPECT_EQ(face_order(input, threads), kept);
+
+        auto parsed = parse(input, threads, true);
+        EXPECT_EQ(parsed.shells, 2u);
+        EXPECT_EQ(parsed.faces_built, 8u);
+        auto& diagnostics = parsed.diagnostics;
+        ASSERT_EQ(diagnostics.size(), 2u);
+
+        EXPECT_EQ(diagnostics[0].id, malformed);
+        EXPECT_EQ(diagnostics[0].entity, "ADVANCED_FACE");
+        EXPECT_EQ(diagnostics[0].offset, keyword_offset(input, malformed));
+        EXPECT_FALSE(diagnostics[0].reason.empty());
+
+        EXPECT_EQ(diagnostics[1].id, dangling);
+        EXPECT_EQ(diagnostics[1].entity, "ADVANCED_FACE");
+        EXPECT_EQ(diagnostics[1].offset, keyword_offset(input, dangling));
+        EXPECT_NE(diagnostics[1].reason.find("1000001"), string::npos)
+            << diagnostics[1].reason;
+    }
+}
+
+// a strict parse fails on the first face that cannot be built instead
+TEST(StepParser, StrictThrowsOnBrokenFace)
+{
+    DiscSample sample(1, 2);
+    auto input = sample.text();
+    replace_record(input, sample.face(0, 1), "ADVANCED_FACE('',(),.T.)");
+    EXPECT_ANY_THROW(parse(input, {1, nullptr}, false));
+    EXPECT_ANY_THROW(parse(input, {4, nullptr}, false));
+}
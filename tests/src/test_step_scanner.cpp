@@ -0,0 +1,94 @@
+#include <step/step_scanner.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+vector<string> scan(string_view input)
+{
+    vector<string> result;
+    StepScanner scanner(input);
+    while (!scanner.eof())
+        result.emplace_back(scanner.next());
+    return result;
+}
+
+} // namespace
+
+TEST(StepScanner, SplitsRecordsAtSemicolons)
+{
+    EXPECT_EQ(scan("#1=A(1);\n#2=B(2);"),
+              (vector<string> {"#1=A(1)", "#2=B(2)"}));
+}
+
+TEST(StepScanner, KeepsSemicolonsInStrings)
+{
+    EXPECT_EQ(scan("#1=A('a;b');#2=B('');"),
+              (vector<string> {"#1=A('a;b')", "#2=B('')"}));
+}
+
+TEST(StepScanner, KeepsSemicolonsInDoubledQuotes)
+{
+    EXPECT_EQ(scan("#1=A('it''s;');#2=B('''');#3=C(';''');"),
+              (vector<string> {"#1=A('it''s;')", "#2=B('''')",
+                               "#3=C(';''')"}));
+}
+
+TEST(StepScanner, KeepsSemicolonsInComments)
+{
+    EXPECT_EQ(scan("#1=A(/* ; */1);"), (vector<string> {"#1=A(/* ; */1)"}));
+    // comments before a record are not part of it
+    EXPECT_EQ(scan("/* ; */ #1=A(1); /* ; */\n#2=B(2);"),
+              (vector<string> {"#1=A(1)", "#2=B(2)"}));
+}
+
+TEST(StepScanner, KeepsSlashesOutsideComments)
+{
+    EXPECT_EQ(scan("#1=A(1/2);"), (vector<string> {"#1=A(1/2)"}));
+}
+
+TEST(StepScanner, ReturnsUnterminatedTail)
+{
+    EXPECT_EQ(scan("#1=A(1);#2=B('x;"),
+              (vector<string> {"#1=A(1)", "#2=B('x;"}));
+}
+
+// Every special character at every offset around the 16 and 32 byte blocks
+// of the vector paths, searched from every start, against the scalar path.
+TEST(StepScanner, VectorPathsMatchScalar)
+{
+    for (auto path : {ScanPath::SSE2, ScanPath::AVX2}) {
+        if (!is_scan_path_supported(path))
+            continue;
+        for (auto special : {';', '\'', '/'}) {
+            for (size_t at = 0; at < 80; ++at) {
+                string input(80, 'x');
+                input[at] = special;
+                for (size_t pos = 0; pos <= input.size(); ++pos)
+                    ASSERT_EQ(
+                        find_record_special(input, pos, path),
+                        find_record_special(input, pos, ScanPath::SCALAR))
+                        << "path " << int(path) << " special " << special
+                        << " at " << at << " from " << pos;
+            }
+        }
+    }
+}
+
+// Records whose ';' and quotes fall on either side of block boundaries.
+TEST(StepScanner, SplitsAcrossBlockBoundaries)
+{
+    for (size_t pad = 0; pad < 70; ++pad) {
+        auto first = "#1=A('" + string(pad, 'a') + ";')";
+        auto second = "#2=B(/*" + string(pad % 33, ';') + "*/)";
+        auto input = first + ";" + second + ";";
+        EXPECT_EQ(scan(input), (vector<string> {first, second}))
+            << "pad " << pad;
+    }
+}
@@ -0,0 +1,93 @@
+#include <step/step_loader.hpp>
+#include <step/step_snapshot.hpp>
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+namespace {
+
+// A disc: one planar face bounded by a circle, with its placement shared
+// by the plane, the circle and the shell.
+constexpr string_view disc = "ISO-10303-21;\n"
+                             "HEADER;\n"
+                             "FILE_DESCRIPTION((''),'2;1');\n"
+                             "ENDSEC;\n"
+                             "DATA;\n"
+                             "#1=CARTESIAN_POINT('',(0.,0.,0.));\n"
+                             "#2=DIRECTION('',(0.,0.,1.));\n"
+                             "#3=DIRECTION('',(1.,0.,0.));\n"
+                             "#4=AXIS2_PLACEMENT_3D('',#1,#2,#3);\n"
+                             "#5=CIRCLE('',#4,2.);\n"
+                             "#6=CARTESIAN_POINT('',(2.,0.,0.));\n"
+                             "#7=VERTEX_POINT('',#6);\n"
+                             "#8=EDGE_CURVE('',#7,#7,#5,.T.);\n"
+                             "#9=ORIENTED_EDGE('',*,*,#8,.T.);\n"
+                             "#10=EDGE_LOOP('',(#9));\n"
+                             "#11=FACE_OUTER_BOUND('',#10,.T.);\n"
+                             "#12=PLANE('',#4);\n"
+                             "#13=ADVANCED_FACE('',(#11),#12,.T.);\n"
+                             "#14=CLOSED_SHELL('',(#13));\n"
+                             "#15=MANIFOLD_SOLID_BREP('',#14);\n"
+                             "#16=ADVANCED_BREP_SHAPE_REPRESENTATION("
+                             "'',(#15,#4),#17);\n"
+                             "ENDSEC;\n"
+                             "END-ISO-10303-21;\n";
+
+string snapshot(string_view input)
+{
+    ostringstream os;
+    StepSnapshot(StepLoader(input)).write(os);
+    return os.str();
+}
+
+} // namespace
+
+TEST(StepSnapshot, ReadsWhatItWrites)
+{
+    auto data = snapshot(disc);
+    ostringstream os;
+    StepSnapshot(data).write(os);
+    EXPECT_EQ(os.str(), data);
+}
+
+TEST(StepSnapshot, StoresSharedEntitiesOnce)
+{
+    auto topo = StepSnapshot(snapshot(disc)).take_topology();
+    ASSERT_EQ(topo.shells.size(), 1u);
+    ASSERT_EQ(topo.shells[0].faces.size(), 1u);
+    EXPECT_EQ(topo.vertices.size(), 1u);
+    ASSERT_EQ(topo.edges.size(), 1u);
+    EXPECT_EQ(topo.edges[0].begin, topo.edges[0].end);
+    auto& outer = topo.shells[0].faces[0].outer;
+    ASSERT_EQ(outer.size(), 1u);
+    EXPECT_EQ(outer[0].edge, 0u);
+    EXPECT_TRUE(outer[0].orient);
+}
+
+TEST(StepSnapshot, RejectsDamagedData)
+{
+    auto data = snapshot(disc);
+    for (size_t size = 0; size < data.size(); ++size)
+        EXPECT_THROW(StepSnapshot(string_view(data).substr(0, size)),
+                     err::bad_snapshot)
+            << "size " << size;
+    EXPECT_THROW(StepSnapshot(data + '\0'), err::bad_snapshot);
+
+    auto other = data;
+    other[8] = char(StepSnapshot::version + 1);
+    EXPECT_THROW(StepSnapshot {other}, err::bad_snapshot);
+}
+
+TEST(StepSnapshot, ThrowsIfStreamFails)
+{
+    ostringstream os;
+    os.setstate(ios::badbit);
+    StepLoader load(disc);
+    StepSnapshot snapshot(load);
+    EXPECT_THROW(snapshot.write(os), err::snapshot_not_written);
+}
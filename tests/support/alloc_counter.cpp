@@ -0,0 +1,82 @@
+#include "alloc_counter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+atomic<size_t> count {0};
+
+void* allocate_aligned(size_t size, size_t align)
+{
+#ifdef _WIN32
+    return _aligned_malloc(size ? size : align, align);
+#else
+    // aligned_alloc takes whole multiples of the alignment only
+    size = (size + align - 1) / align * align;
+    return aligned_alloc(align, size ? size : align);
+#endif
+}
+
+// memory from allocate_aligned() must not go to free() on Windows
+void free_aligned(void* p)
+{
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+
+} // namespace
+
+size_t allocation_count()
+{
+    return count.load(memory_order_relaxed);
+}
+
+// the array and nothrow forms call these, so they are counted as well
+void* operator new(size_t size)
+{
+    count.fetch_add(1, memory_order_relaxed);
+    if (auto result = malloc(size ? size : 1))
+        return result;
+    throw bad_alloc();
+}
+
+// memory resources such as std::pmr::new_delete_resource() allocate with
+// an alignment
+void* operator new(size_t size, align_val_t alignment)
+{
+    count.fetch_add(1, memory_order_relaxed);
+    if (auto result = allocate_aligned(size, size_t(alignment)))
+        return result;
+    throw bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, align_val_t) noexcept
+{
+    free_aligned(p);
+}
+
+void operator delete(void* p, size_t, align_val_t) noexcept
+{
+    free_aligned(p);
+}
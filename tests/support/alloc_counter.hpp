@@ -0,0 +1,11 @@
+#ifndef STEPPARSE_TESTS_SUPPORT_ALLOC_COUNTER_HPP_
+#define STEPPARSE_TESTS_SUPPORT_ALLOC_COUNTER_HPP_
+
+#include <cstddef>
+
+// Heap allocations made through the global operator new since the program
+// started, by all threads. Differences around a piece of code tell how many
+// allocations it makes. Linked into both the tests and the benchmarks.
+size_t allocation_count();
+
+#endif // STEPPARSE_TESTS_SUPPORT_ALLOC_COUNTER_HPP_